@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    BackgroundDesigner.cpp
+
+  ==============================================================================
+*/
+
+#include "BackgroundDesigner.h"
+
+BackgroundDesigner::BackgroundDesigner (ParameterSnapshot& parametersToWatch)
+    : juce::Thread ("Vonic designer"),
+      parameters (parametersToWatch)
+{
+}
+
+BackgroundDesigner::~BackgroundDesigner()
+{
+    release();
+}
+
+//==============================================================================
+void BackgroundDesigner::prepare (double newSampleRate, bool shouldDesignCrossover, ChainDesigner designToUse)
+{
+    release();
+
+    sampleRate = newSampleRate;
+    withCrossover = shouldDesignCrossover;
+    designer = designToUse;
+    numDesigns = 0;
+
+    // Nothing is reading while the audio thread is stopped, so the old set
+    // can go straight away.
+    FilterSet settings;
+    juce::uint32 version = 0;
+
+    while (! parameters.tryRead (settings, &version))
+        std::this_thread::yield();
+
+    current = design (settings, version);
+    current->serial = ++numDesigns;
+    lastVersion = version;
+    published = current.get();
+    retired.clear();
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void BackgroundDesigner::release()
+{
+    // The thread sleeps in the snapshot's waitForChange(), not on the
+    // event stopThread() would signal.
+    signalThreadShouldExit();
+    parameters.wake();
+    stopThread (1000);
+
+    // Only the published set can still be in use, and only once the audio
+    // thread starts again.
+    retired.clear();
+}
+
+//==============================================================================
+const BackgroundDesigner::Design* BackgroundDesigner::beginRead() noexcept
+{
+    ++readCount;
+    return published.load();
+}
+
+void BackgroundDesigner::endRead() noexcept
+{
+    ++readCount;
+}
+
+//==============================================================================
+void BackgroundDesigner::run()
+{
+    while (! threadShouldExit())
+    {
+        // Taken before the checks, so that a change during them ends the
+        // wait below at once.
+        const auto changeCount = parameters.getChangeCount();
+
+        FilterSet settings;
+        juce::uint32 version = 0;
+
+        // A failed read means a publish is under way, and it will bring the
+        // thread straight back round. Republishing the same values moves the version but needs no design.
+        if (parameters.tryRead (settings, &version) && version != lastVersion)
+        {
+            lastVersion = version;
+
+            if (settings != current->settings)
+                publish (design (settings, version));
+        }
+
+        reclaim();
+
+        // Sets still retired wait on a block that is running, which won't
+        // be long.
+        parameters.waitForChange (changeCount, retired.empty() ? -1 : reclaimIntervalMs);
+    }
+}
+
+std::unique_ptr<BackgroundDesigner::Design> BackgroundDesigner::design (const FilterSet& settings, juce::uint32 version) const
+{
+    auto result = std::make_unique<Design>();
+    result->settings = settings;
+    result->version = version;
+
+    for (size_t i = 0; i < slopeLimits.size(); ++i)
+    {
+        auto limited = settings;
+        limited.lowCutSlope = juce::jmin (limited.lowCutSlope, slopeLimits[i]);
+        limited.highCutSlope = juce::jmin (limited.highCutSlope, slopeLimits[i]);
+
+        // A cap that neither slope reaches changes nothing.
+        if (i > 0 && limited == settings)
+        {
+            result->capped[i] = result->capped[i - 1];
+            continue;
+        }
+
+        result->capped[i].chain = designer (limited, sampleRate);
+
+        if (withCrossover)
+            result->capped[i].crossover = designCrossover (limited, sampleRate, designer);
+    }
+
+    return result;
+}
+
+void BackgroundDesigner::publish (std::unique_ptr<Design> newDesign)
+{
+    newDesign->serial = ++numDesigns;
+    published = newDesign.get();
+
+    // An even count means no block was running at the swap, so the next one
+    // to start will load the new set. An odd one means a block may still be
+    // reading the old set until the count moves on.
+    retired.push_back ({ std::move (current), readCount.load() });
+    current = std::move (newDesign);
+}
+
+void BackgroundDesigner::reclaim()
+{
+    const auto count = readCount.load();
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(), [count] (const Retired& r)
+                   {
+                       return (r.readCountWhenSwapped & 1) == 0 || count != r.readCountWhenSwapped;
+                   }),
+                   retired.end());
+}
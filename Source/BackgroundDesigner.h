@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    BackgroundDesigner.h
+
+    Keeps filter design off the audio thread. A low-priority thread sleeps
+    until the ParameterSnapshot wakes it, designs a complete, immutable set
+    of coefficients whenever the settings have moved, and publishes it with
+    one atomic pointer swap. All the audio thread does is load that pointer at the start of a
+    block, and copy the coefficients in if it has changed.
+
+    Old sets are reclaimed the way RCU does it: the audio thread counts its
+    way into and out of every block, and a set that has been swapped out is
+    only deleted once that count shows no block can still be reading it.
+    Deletion happens on the designer thread.
+
+    A change reaches the audio thread a thread wake-up plus one design later
+    than it would if processBlock designed it, usually within a block. With
+    nothing changing, the thread doesn't run at all on Linux, and only
+    looks for a change every millisecond elsewhere.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+#include "Crossover.h"
+#include "ParameterSnapshot.h"
+
+class BackgroundDesigner  : private juce::Thread
+{
+public:
+    /** The caps on both cut slopes that every set is designed for, from
+        none down, so the audio thread can move between them on its own.
+    */
+    static constexpr std::array<Gradient, 3> slopeLimits { grad96, grad48, grad24 };
+
+    struct Coefficients
+    {
+        ChainCoefficients chain;
+
+        /** Only designed when prepare() was asked for it. */
+        CrossoverCoefficients crossover;
+    };
+
+    /** One published design. Never changed once the audio thread can see it. */
+    struct Design
+    {
+        /** The slopes as asked for, whichever cap is applied. */
+        FilterSet settings;
+
+        /** The coefficients under each of slopeLimits, in the same order. */
+        std::array<Coefficients, slopeLimits.size()> capped;
+
+        /** The coefficients under the tightest of slopeLimits that is no
+            steeper than limit.
+        */
+        const Coefficients& getCoefficients (Gradient limit) const noexcept
+        {
+            for (size_t i = 0; i < slopeLimits.size(); ++i)
+                if (slopeLimits[i] <= limit)
+                    return capped[i];
+
+            return capped.back();
+        }
+
+        /** ParameterSnapshot's version of the settings this came from. */
+        juce::uint32 version = 0;
+
+        /** Counts up from 1 with every set published since prepare(). Use
+            this rather than the address to spot a new set: a freed set's
+            memory can come straight back for the next one.
+        */
+        juce::uint32 serial = 0;
+    };
+
+    explicit BackgroundDesigner (ParameterSnapshot& parameters);
+    ~BackgroundDesigner() override;
+
+    /** Designs the current settings before returning, so there is always a
+        set to read, then keeps designing in the background. Call from
+        prepareToPlay(), while the audio thread is stopped.
+    */
+    void prepare (double sampleRate, bool withCrossover, ChainDesigner design);
+
+    /** Stops the thread and frees everything but the latest set. */
+    void release();
+
+    /** The latest set, or nullptr before prepare(). The pointer stays valid
+        until the matching endRead(). Wait-free; for the audio thread only,
+        once per block.
+    */
+    const Design* beginRead() noexcept;
+    void endRead() noexcept;
+
+    /** How many sets have been designed since prepare(), counting its own. */
+    juce::uint32 getNumDesigns() const noexcept   { return numDesigns.load (std::memory_order_relaxed); }
+
+    /** How often retired sets are checked for while a block may still be
+        reading them. Only then does the thread wake up on its own.
+    */
+    static constexpr int reclaimIntervalMs = 1;
+
+private:
+    void run() override;
+    std::unique_ptr<Design> design (const FilterSet& settings, juce::uint32 version) const;
+    void publish (std::unique_ptr<Design> design);
+    void reclaim();
+
+    ParameterSnapshot& parameters;
+    double sampleRate = 44100.0;
+    bool withCrossover = false;
+    ChainDesigner designer = designChainCached;
+
+    // Everything here is seq_cst, which is what makes the count a reliable
+    // record of whether a block started before or after a swap.
+    std::atomic<const Design*> published { nullptr };
+    std::atomic<juce::uint64> readCount { 0 };
+
+    // Owned by the designer thread, or by prepare() while it isn't running.
+    struct Retired
+    {
+        std::unique_ptr<Design> design;
+        juce::uint64 readCountWhenSwapped = 0;
+    };
+
+    std::unique_ptr<Design> current;
+    juce::uint32 lastVersion = 0;
+    std::vector<Retired> retired;
+    std::atomic<juce::uint32> numDesigns { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundDesigner)
+};
@@ -0,0 +1,960 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+
+#if VONIC_BENCHMARKS
+
+#include "CommandLine.h"
+#include "BlockCascade.h"
+#include "ChainDesign.h"
+#include "Crossover.h"
+#include "ParallelForm.h"
+#include "ParameterSnapshot.h"
+#include "PluginProcessor.h"
+#include "WorkerPool.h"
+
+//==============================================================================
+namespace
+{
+    // Cascade's arithmetic without the anti-denormal offset, for comparison.
+    struct UnguardedCascade
+    {
+        explicit UnguardedCascade (const ChainCoefficients& chain)
+        {
+            numSections = getActiveSections (chain, sections);
+        }
+
+        void process (float* samples, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = samples[i];
+
+                for (int k = 0; k < numSections; ++k)
+                {
+                    const auto& c = sections[(size_t) k];
+                    const auto y = c.b0 * x + s1[(size_t) k];
+                    s1[(size_t) k] = c.b1 * x - c.a1 * y + s2[(size_t) k];
+                    s2[(size_t) k] = c.b2 * x - c.a2 * y;
+                    x = y;
+                }
+
+                samples[i] = x;
+            }
+        }
+
+        std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+        std::array<float, ChainCoefficients::maxSections> s1 {}, s2 {};
+        int numSections = 0;
+    };
+
+    struct DenormalResult
+    {
+        /** Median time per block over the transient, over the silence
+            after it, and over the slowest 100 ms of that silence.
+        */
+        double transientMicroseconds = 0.0, tailMicroseconds = 0.0, slowestTailMicroseconds = 0.0;
+
+        /** The same, with the anti-denormal offset left out. */
+        double unguardedTransientMicroseconds = 0.0, unguardedTailMicroseconds = 0.0, unguardedSlowestTailMicroseconds = 0.0;
+    };
+}
+
+/** Times every block of a 100 ms full-scale noise burst followed by
+    tailSeconds of digital silence, with denormals left enabled as a host
+    that doesn't set FTZ/DAZ would leave them. Without the offset, the
+    decaying state goes denormal and stretches of the silence get slower
+    than the noise; with it, they shouldn't.
+*/
+static DenormalResult runDenormalBenchmark (const ChainCoefficients& chain, double sampleRate, int blockSize, double tailSeconds)
+{
+    const auto numTransientBlocks = juce::jmax (1, juce::roundToInt (0.1 * sampleRate / blockSize));
+    const auto numTailBlocks = juce::jmax (1, juce::roundToInt (tailSeconds * sampleRate / blockSize));
+
+    juce::AudioBuffer<float> buffer (1, blockSize);
+    auto* samples = buffer.getWritePointer (0);
+
+    struct Times { double transient = 0.0, tail = 0.0, slowestTail = 0.0; };
+    std::vector<double> blockTimes ((size_t) (numTransientBlocks + numTailBlocks));
+
+    // Medians, so that a block the scheduler happened to delay doesn't count.
+    const auto getMedian = [] (std::vector<double>::iterator begin, std::vector<double>::iterator end)
+    {
+        std::vector<double> sorted (begin, end);
+        std::nth_element (sorted.begin(), sorted.begin() + (std::ptrdiff_t) sorted.size() / 2, sorted.end());
+        return sorted[sorted.size() / 2];
+    };
+
+    const auto timeBlocks = [&] (auto&& processBlock)
+    {
+        juce::Random random (1);
+
+        for (int block = 0; block < numTransientBlocks + numTailBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                samples[i] = block < numTransientBlocks ? random.nextFloat() * 2.0f - 1.0f : 0.0f;
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processBlock (samples, blockSize);
+            blockTimes[(size_t) block] = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+        }
+
+        const auto tailStart = blockTimes.begin() + numTransientBlocks;
+
+        Times times;
+        times.transient = getMedian (blockTimes.begin(), tailStart);
+        times.tail = getMedian (tailStart, blockTimes.end());
+
+        // The state takes seconds to decay through the denormal range, so
+        // the slowdown shows over whole 100 ms stretches of the silence.
+        for (int block = 0; block < numTailBlocks; block += numTransientBlocks)
+        {
+            const auto window = tailStart + block;
+            const auto windowEnd = window + juce::jmin (numTransientBlocks, numTailBlocks - block);
+            times.slowestTail = juce::jmax (times.slowestTail, getMedian (window, windowEnd));
+        }
+
+        return times;
+    };
+
+    // What a host that leaves denormals alone gives us; put back afterwards.
+    const auto wereDisabled = juce::FloatVectorOperations::areDenormalsDisabled();
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport (false);
+
+    Cascade cascade;
+    cascade.setCoefficients (chain);
+    const auto guarded = timeBlocks ([&] (float* s, int n) { cascade.process (s, n); });
+
+    UnguardedCascade unguardedCascade (chain);
+    const auto unguarded = timeBlocks ([&] (float* s, int n) { unguardedCascade.process (s, n); });
+
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport (wereDisabled);
+
+    DenormalResult result;
+    result.transientMicroseconds = guarded.transient;
+    result.tailMicroseconds = guarded.tail;
+    result.slowestTailMicroseconds = guarded.slowestTail;
+    result.unguardedTransientMicroseconds = unguarded.transient;
+    result.unguardedTailMicroseconds = unguarded.tail;
+    result.unguardedSlowestTailMicroseconds = unguarded.slowestTail;
+    return result;
+}
+
+static void benchDenormalsCommand (const juce::ArgumentList& args)
+{
+    const auto sampleRate = args.containsOption ("--sample-rate") ? juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue()) : 48000.0;
+    const auto blockSize = args.containsOption ("--block-size") ? juce::jlimit (16, 8192, args.getValueForOption ("--block-size").getIntValue()) : 128;
+    const auto tailSeconds = args.containsOption ("--seconds") ? juce::jmax (1.0, args.getValueForOption ("--seconds").getDoubleValue()) : 20.0;
+    const auto chain = designChain (parseFilterSet (args), sampleRate);
+    const auto result = runDenormalBenchmark (chain, sampleRate, blockSize, tailSeconds);
+
+    const auto printRow = [] (const char* name, double transient, double tail, double slowestTail)
+    {
+        std::cout << name << juce::String (transient, 2).paddedLeft (' ', 11) << juce::String (tail, 2).paddedLeft (' ', 8)
+                  << juce::String (slowestTail, 2).paddedLeft (' ', 14)
+                  << (juce::String (slowestTail / juce::jmax (1.0e-6, transient), 2) + "x").paddedLeft (' ', 9) << std::endl;
+    };
+
+    std::cout << "us per block of " << blockSize << ", " << chain.numLowCut + 1 + chain.numHighCut << " sections at " << sampleRate
+              << " Hz, 100 ms of noise then " << tailSeconds << " s of silence, denormals enabled:" << std::endl
+              << "            transient    tail  slowest 100 ms  against transient" << std::endl;
+    printRow ("guarded  ", result.transientMicroseconds, result.tailMicroseconds, result.slowestTailMicroseconds);
+    printRow ("unguarded", result.unguardedTransientMicroseconds, result.unguardedTailMicroseconds, result.unguardedSlowestTailMicroseconds);
+
+    if (result.slowestTailMicroseconds > 1.5 * result.transientMicroseconds)
+        juce::ConsoleApplication::fail ("The guarded cascade slows down by more than half in the silence");
+}
+
+//==============================================================================
+#if VONIC_TELEMETRY
+/** Times what processBlock records for each block, in ns per block: the
+    clock reads, the histogram and counter updates and a reset count.
+*/
+static double runTelemetryBenchmark (int numBlocks)
+{
+    Telemetry telemetry;
+    numBlocks = juce::jmax (1, numBlocks);
+
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        const auto startTicks = Telemetry::startBlock();
+        telemetry.addStateResets ((juce::uint32) (i & 1));
+        telemetry.endBlock (startTicks);
+    }
+
+    return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numBlocks;
+}
+#endif
+
+static void benchTelemetryCommand (const juce::ArgumentList& args)
+{
+   #if VONIC_TELEMETRY
+    const auto blockSize = args.containsOption ("--block-size") ? juce::jlimit (16, 8192, args.getValueForOption ("--block-size").getIntValue()) : 128;
+    const auto numBlocks = args.containsOption ("--blocks") ? juce::jmax (100, args.getValueForOption ("--blocks").getIntValue()) : 20000;
+    constexpr double sampleRate = 48000.0;
+
+    VonicRewriteAudioProcessor processor;
+    setFilterSet (processor.bleh, parseFilterSet (args));
+    processor.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+    processor.setNonRealtime (true);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random (1);
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int n = 0; n < blockSize; ++n)
+                buffer.setSample (ch, n, random.nextFloat() * 0.5f - 0.25f);
+
+        processor.processBlock (buffer, midi);
+    }
+
+    processor.releaseResources();
+
+    // The block times telemetry reports include its own cost, so that comes
+    // off before comparing.
+    const auto recordingNanoseconds = runTelemetryBenchmark (numBlocks * 10);
+    const auto blockNanoseconds = processor.getTelemetry().getSnapshot().averageBlockMicros * 1000.0;
+    const auto overhead = recordingNanoseconds / juce::jmax (1.0, blockNanoseconds - recordingNanoseconds);
+
+    std::cout << "Stereo blocks of " << blockSize << " at 48 kHz, over " << numBlocks << " blocks:" << std::endl
+              << "  processBlock: " << juce::String (blockNanoseconds / 1000.0, 2) << " us" << std::endl
+              << "  recording telemetry: " << juce::String (recordingNanoseconds, 1) << " ns ("
+              << juce::String (overhead * 100.0, 2) << "% of the rest)" << std::endl;
+
+    if (overhead >= 0.01)
+        juce::ConsoleApplication::fail ("Telemetry costs 1% or more of processBlock");
+   #else
+    juce::ignoreUnused (args);
+    juce::ConsoleApplication::fail ("This build has telemetry compiled out (VONIC_TELEMETRY=0)");
+   #endif
+}
+
+//==============================================================================
+namespace
+{
+    // The crossover as it was before it used Cascade: every section a Biquad
+    // making its own pass over the block.
+    struct StagedCrossover
+    {
+        explicit StagedCrossover (const CrossoverCoefficients& coefficients)
+        {
+            peak.coefficients = coefficients.peak;
+
+            Crossover::BandSections band;
+            numLowBand = set (lowBand, band, Crossover::makeBand (band, coefficients.lowSplitLowPass, coefficients.numLowSplit));
+            numLowSplitHighPass = set (lowSplitHighPass, band, Crossover::makeBand (band, coefficients.lowSplitHighPass,
+                                                                                    coefficients.numLowSplit, coefficients.lowSplitIsOdd));
+            numMidBand = set (midBand, band, Crossover::makeBand (band, coefficients.highSplitLowPass, coefficients.numHighSplit));
+            numHighBand = set (highBand, band, Crossover::makeBand (band, coefficients.highSplitHighPass, coefficients.numHighSplit,
+                                                                    coefficients.highSplitIsOdd));
+
+            Crossover::Sections allpass;
+            numLowBandAllpass = set (lowBandAllpass, allpass, Crossover::makeAllpass (allpass, coefficients));
+        }
+
+        template <typename Band, typename Coefficients>
+        static int set (Band& band, const Coefficients& sections, int numSections) noexcept
+        {
+            for (int i = 0; i < numSections; ++i)
+                band[(size_t) i].coefficients = sections[(size_t) i];
+
+            return numSections;
+        }
+
+        template <typename Band>
+        static void run (Band& band, int numSections, float* samples, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSections; ++i)
+                band[(size_t) i].processSamples (samples, samples, numSamples);
+        }
+
+        void process (float* low, float* mid, float* high, int numSamples) noexcept
+        {
+            peak.processSamples (mid, mid, numSamples);
+
+            juce::FloatVectorOperations::copy (low, mid, numSamples);
+            run (lowBand, numLowBand, low, numSamples);
+            run (lowBandAllpass, numLowBandAllpass, low, numSamples);
+
+            run (lowSplitHighPass, numLowSplitHighPass, mid, numSamples);
+
+            juce::FloatVectorOperations::copy (high, mid, numSamples);
+            run (highBand, numHighBand, high, numSamples);
+            run (midBand, numMidBand, mid, numSamples);
+        }
+
+        Biquad peak;
+        std::array<Biquad, 2 * ChainCoefficients::maxCutSections> lowBand, lowSplitHighPass, midBand, highBand;
+        std::array<Biquad, ChainCoefficients::maxCutSections> lowBandAllpass;
+        int numLowBand = 0, numLowSplitHighPass = 0, numMidBand = 0, numHighBand = 0, numLowBandAllpass = 0;
+    };
+
+    struct CrossoverResult
+    {
+        int blockSize = 0;
+        double stagedNanoseconds = 0.0, fusedNanoseconds = 0.0;
+        float maxDifference = 0.0f;
+    };
+}
+
+/** Times the Crossover against the same crossover run a Biquad at a time,
+    as it was before, per sample of one channel, at block sizes from 32 to
+    4096. maxDifference is the largest difference in any of the bands.
+*/
+static std::vector<CrossoverResult> runCrossoverBenchmark (const CrossoverCoefficients& coefficients, int numSamplesPerSize)
+{
+    std::vector<CrossoverResult> results;
+
+    // Low, mid and high, the mid channel holding the input to begin with.
+    juce::AudioBuffer<float> input (1, numSamplesPerSize), staged (3, numSamplesPerSize), fused (3, numSamplesPerSize);
+    juce::Random random (1);
+
+    for (int i = 0; i < numSamplesPerSize; ++i)
+        input.setSample (0, i, random.nextFloat() * 2.0f - 1.0f);
+
+    for (int blockSize = 32; blockSize <= 4096; blockSize *= 2)
+    {
+        StagedCrossover stagedCrossover (coefficients);
+
+        Crossover crossover;
+        crossover.setCoefficients (coefficients);
+
+        staged.copyFrom (1, 0, input, 0, 0, numSamplesPerSize);
+        fused.copyFrom (1, 0, input, 0, 0, numSamplesPerSize);
+
+        const auto timeBlocks = [&] (juce::AudioBuffer<float>& buffer, auto&& processBlock)
+        {
+            auto* const* bands = buffer.getArrayOfWritePointers();
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int offset = 0; offset < numSamplesPerSize; offset += blockSize)
+                processBlock (bands[0] + offset, bands[1] + offset, bands[2] + offset, juce::jmin (blockSize, numSamplesPerSize - offset));
+
+            return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numSamplesPerSize;
+        };
+
+        CrossoverResult result;
+        result.blockSize = blockSize;
+        result.stagedNanoseconds = timeBlocks (staged, [&] (float* low, float* mid, float* high, int numSamples)
+        {
+            stagedCrossover.process (low, mid, high, numSamples);
+        });
+        result.fusedNanoseconds = timeBlocks (fused, [&] (float* low, float* mid, float* high, int numSamples)
+        {
+            crossover.process (low, mid, high, numSamples);
+        });
+
+        for (int ch = 0; ch < 3; ++ch)
+            for (int i = 0; i < numSamplesPerSize; ++i)
+                result.maxDifference = juce::jmax (result.maxDifference, std::abs (staged.getSample (ch, i) - fused.getSample (ch, i)));
+
+        results.push_back (result);
+    }
+
+    return results;
+}
+
+static void benchCrossoverCommand (const juce::ArgumentList& args)
+{
+    const auto numSamples = args.containsOption ("--samples") ? juce::jmax (4096, args.getValueForOption ("--samples").getIntValue()) : 1 << 20;
+    const auto coefficients = designCrossover (parseFilterSet (args), 48000.0, designChain);
+
+    std::cout << "ns per sample of one channel, splits of " << 2 * coefficients.numLowSplit << " and " << 2 * coefficients.numHighSplit
+              << " sections at 48 kHz:" << std::endl
+              << "block  staged  fused  speed-up  max difference" << std::endl;
+
+    auto identical = true;
+
+    for (auto& result : runCrossoverBenchmark (coefficients, numSamples))
+    {
+        std::cout << juce::String (result.blockSize).paddedLeft (' ', 5)
+                  << juce::String (result.stagedNanoseconds, 2).paddedLeft (' ', 8)
+                  << juce::String (result.fusedNanoseconds, 2).paddedLeft (' ', 7)
+                  << (juce::String (result.stagedNanoseconds / juce::jmax (1.0e-9, result.fusedNanoseconds), 2) + "x").paddedLeft (' ', 10)
+                  << "  " << result.maxDifference << std::endl;
+
+        identical = identical && result.maxDifference == 0.0f;
+    }
+
+    if (! identical)
+        juce::ConsoleApplication::fail ("The fused crossover's bands differ from the staged one's");
+}
+
+//==============================================================================
+namespace
+{
+    struct ParametersResult
+    {
+        double lookupNanoseconds = 0.0, snapshotNanoseconds = 0.0;
+    };
+}
+
+/** Times getFilterSet() against ParameterSnapshot::tryRead() on the same state. */
+static ParametersResult runParametersBenchmark (juce::AudioProcessorValueTreeState& state, int numReads)
+{
+    ParameterSnapshot snapshot (state);
+    ParametersResult result;
+    numReads = juce::jmax (1, numReads);
+
+    // Keeps the optimiser from dropping the reads being timed.
+    volatile float sink = 0.0f;
+
+    const auto timeReads = [&] (auto&& read)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numReads; ++i)
+            sink = sink + read().peakFreq;
+
+        return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numReads;
+    };
+
+    result.lookupNanoseconds = timeReads ([&] { return getFilterSet (state); });
+    result.snapshotNanoseconds = timeReads ([&]
+    {
+        FilterSet settings;
+        snapshot.tryRead (settings);
+        return settings;
+    });
+
+    return result;
+}
+
+static void benchParametersCommand (const juce::ArgumentList& args)
+{
+    const auto numReads = args.containsOption ("--reads") ? juce::jmax (1, args.getValueForOption ("--reads").getIntValue()) : 1000000;
+
+    VonicRewriteAudioProcessor processor;
+    const auto result = runParametersBenchmark (processor.bleh, numReads);
+
+    std::cout << "Reading the EQ settings once per block, over " << numReads << " reads:" << std::endl
+              << "  by parameter ID: " << juce::String (result.lookupNanoseconds, 1) << " ns" << std::endl
+              << "  from the snapshot: " << juce::String (result.snapshotNanoseconds, 1) << " ns ("
+              << juce::String (result.lookupNanoseconds / juce::jmax (1.0e-3, result.snapshotNanoseconds), 1) << "x)" << std::endl;
+}
+
+//==============================================================================
+// The plugin's chain as it was before Cascade replaced it: every section a
+// ProcessorChain stage, each making its own pass over the block.
+namespace
+{
+    using CutFilter = juce::dsp::ProcessorChain<Biquad, Biquad, Biquad, Biquad, Biquad, Biquad, Biquad, Biquad>;
+    using StagedChain = juce::dsp::ProcessorChain<CutFilter, Biquad, CutFilter>;
+    static_assert (ChainCoefficients::maxCutSections == 8, "CutFilter needs a Biquad per cut section");
+
+    template <size_t... Indices>
+    void setCutFilter (CutFilter& cut, const std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections, int numSections,
+                       std::index_sequence<Indices...>)
+    {
+        ((cut.get<Indices>().coefficients = sections[Indices]), ...);
+        (cut.setBypassed<Indices> ((int) Indices >= numSections), ...);
+    }
+
+    void setCutFilter (CutFilter& cut, const std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections, int numSections)
+    {
+        setCutFilter (cut, sections, numSections, std::make_index_sequence<(size_t) ChainCoefficients::maxCutSections>());
+    }
+
+    struct CascadeResult
+    {
+        int blockSize = 0;
+        double stagedNanoseconds = 0.0, fusedNanoseconds = 0.0;
+        float maxDifference = 0.0f;
+    };
+}
+
+/** Times Cascade against the ProcessorChain of Biquads it replaced, per
+    sample, at block sizes from 32 to 4096.
+*/
+static std::vector<CascadeResult> runCascadeBenchmark (const ChainCoefficients& chain, int numSamplesPerSize)
+{
+    std::vector<CascadeResult> results;
+
+    juce::AudioBuffer<float> input (1, numSamplesPerSize), staged (1, numSamplesPerSize), fused (1, numSamplesPerSize);
+    juce::Random random (1);
+
+    for (int i = 0; i < numSamplesPerSize; ++i)
+        input.setSample (0, i, random.nextFloat() * 2.0f - 1.0f);
+
+    for (int blockSize = 32; blockSize <= 4096; blockSize *= 2)
+    {
+        StagedChain stagedChain;
+        setCutFilter (stagedChain.get<0>(), chain.lowCut, chain.numLowCut);
+        stagedChain.get<1>().coefficients = chain.peak;
+        setCutFilter (stagedChain.get<2>(), chain.highCut, chain.numHighCut);
+
+        Cascade cascade;
+        cascade.setCoefficients (chain);
+
+        staged.makeCopyOf (input, true);
+        fused.makeCopyOf (input, true);
+
+        const auto timeBlocks = [&] (juce::AudioBuffer<float>& buffer, auto&& processBlock)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int offset = 0; offset < numSamplesPerSize; offset += blockSize)
+                processBlock (buffer.getWritePointer (0, offset), juce::jmin (blockSize, numSamplesPerSize - offset));
+
+            return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numSamplesPerSize;
+        };
+
+        CascadeResult result;
+        result.blockSize = blockSize;
+        result.stagedNanoseconds = timeBlocks (staged, [&] (float* samples, int numSamples)
+        {
+            juce::dsp::AudioBlock<float> block (&samples, 1, (size_t) numSamples);
+            stagedChain.process (juce::dsp::ProcessContextReplacing<float> (block));
+        });
+        result.fusedNanoseconds = timeBlocks (fused, [&] (float* samples, int numSamples) { cascade.process (samples, numSamples); });
+
+        for (int i = 0; i < numSamplesPerSize; ++i)
+            result.maxDifference = juce::jmax (result.maxDifference, std::abs (staged.getSample (0, i) - fused.getSample (0, i)));
+
+        results.push_back (result);
+    }
+
+    return results;
+}
+
+static void benchCascadeCommand (const juce::ArgumentList& args)
+{
+    const auto numSamples = args.containsOption ("--samples") ? juce::jmax (4096, args.getValueForOption ("--samples").getIntValue()) : 1 << 20;
+    const auto chain = designChain (parseFilterSet (args), 48000.0);
+
+    std::cout << "ns per sample, " << chain.numLowCut + 1 + chain.numHighCut << " sections at 48 kHz:" << std::endl
+              << "block  staged  fused  speed-up  max difference" << std::endl;
+
+    auto identical = true;
+
+    for (auto& result : runCascadeBenchmark (chain, numSamples))
+    {
+        std::cout << juce::String (result.blockSize).paddedLeft (' ', 5)
+                  << juce::String (result.stagedNanoseconds, 2).paddedLeft (' ', 8)
+                  << juce::String (result.fusedNanoseconds, 2).paddedLeft (' ', 7)
+                  << (juce::String (result.stagedNanoseconds / juce::jmax (1.0e-9, result.fusedNanoseconds), 2) + "x").paddedLeft (' ', 10)
+                  << "  " << result.maxDifference << std::endl;
+
+        identical = identical && result.maxDifference == 0.0f;
+    }
+
+    if (! identical)
+        juce::ConsoleApplication::fail ("The fused cascade's output differs from the staged chain's");
+}
+
+//==============================================================================
+namespace
+{
+    struct MonoResult
+    {
+        BlockCascade::InstructionSet instructionSet = BlockCascade::InstructionSet::generic;
+        double cascadeSamplesPerSecond = 0.0, blockSamplesPerSecond = 0.0;
+
+        /** Largest difference from the chain run in double, relative to the
+            output's peak.
+        */
+        double cascadeErrorDb = -400.0, blockErrorDb = -400.0;
+
+        /** Rounding differs from Cascade's, but shouldn't be any worse. */
+        bool isWithinBounds() const noexcept   { return blockErrorDb <= juce::jmax (cascadeErrorDb, -120.0) + errorMarginDb; }
+
+        static constexpr double errorMarginDb = 6.0;
+    };
+}
+
+/** Runs numSamples of mono noise through Cascade and through each
+    instruction set this CPU supports, timing them and comparing both
+    with the same chain run in double.
+*/
+static std::vector<MonoResult> runMonoBenchmark (const ChainCoefficients& chain, int numSamples)
+{
+    std::vector<float> input ((size_t) numSamples), output;
+    juce::Random random (1);
+
+    for (auto& sample : input)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    // Both float kernels are measured against the same chain run in double,
+    // since with steep low cuts at high rates the float coefficients alone
+    // put Cascade itself well away from the ideal response.
+    std::vector<double> reference (input.begin(), input.end());
+    processInDouble (chain, reference.data(), numSamples);
+
+    double peak = 0.0;
+
+    for (auto sample : reference)
+        peak = juce::jmax (peak, std::abs (sample));
+
+    const auto timeRender = [&] (auto&& process, double& errorDb)
+    {
+        output = input;
+        const auto start = juce::Time::getHighResolutionTicks();
+        process (output.data(), numSamples);
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        double maxError = 0.0;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            maxError = juce::jmax (maxError, std::abs ((double) output[i] - reference[i]));
+
+        errorDb = juce::Decibels::gainToDecibels (maxError / juce::jmax (1.0e-9, peak), -400.0);
+        return numSamples / juce::jmax (1.0e-9, seconds);
+    };
+
+    Cascade cascade;
+    cascade.setCoefficients (chain);
+
+    double cascadeErrorDb = 0.0;
+    const auto cascadeSamplesPerSecond = timeRender ([&] (float* samples, int n) { cascade.process (samples, n); }, cascadeErrorDb);
+
+    std::vector<MonoResult> results;
+
+    using InstructionSet = BlockCascade::InstructionSet;
+
+    for (auto set : { InstructionSet::generic, InstructionSet::avx2, InstructionSet::avx512 })
+    {
+        if (! BlockCascade::isSupported (set))
+            continue;
+
+        BlockCascade blockCascade (set);
+        blockCascade.setCoefficients (chain);
+
+        MonoResult result;
+        result.instructionSet = set;
+        result.cascadeSamplesPerSecond = cascadeSamplesPerSecond;
+        result.cascadeErrorDb = cascadeErrorDb;
+        result.blockSamplesPerSecond = timeRender ([&] (float* samples, int n) { blockCascade.process (samples, n); }, result.blockErrorDb);
+        results.push_back (result);
+    }
+
+    return results;
+}
+
+static void benchMonoCommand (const juce::ArgumentList& args)
+{
+    const auto sampleRate = args.containsOption ("--sample-rate") ? juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue()) : 48000.0;
+    const auto numSamples = args.containsOption ("--samples") ? juce::jmax (4096, args.getValueForOption ("--samples").getIntValue()) : 1 << 22;
+    const auto chain = designChain (parseFilterSet (args), sampleRate);
+
+    std::cout << "Mono throughput, " << chain.numLowCut + 1 + chain.numHighCut << " sections at " << sampleRate << " Hz, "
+              << "error against the chain in double:" << std::endl;
+
+    auto withinBounds = true;
+
+    for (auto& result : runMonoBenchmark (chain, numSamples))
+    {
+        std::cout << "  " << BlockCascade::getName (result.instructionSet) << " ("
+                  << BlockCascade::getBlockWidth (result.instructionSet) << " samples a step): "
+                  << juce::String (result.blockSamplesPerSecond * 1.0e-6, 1) << " M samples/s against "
+                  << juce::String (result.cascadeSamplesPerSecond * 1.0e-6, 1) << " ("
+                  << juce::String (result.blockSamplesPerSecond / juce::jmax (1.0, result.cascadeSamplesPerSecond), 2) << "x), error "
+                  << juce::String (result.blockErrorDb, 1) << " dB against " << juce::String (result.cascadeErrorDb, 1) << " dB" << std::endl;
+
+        withinBounds = withinBounds && result.isWithinBounds();
+    }
+
+    if (! withinBounds)
+        juce::ConsoleApplication::fail ("The block kernel is more than " + juce::String (MonoResult::errorMarginDb)
+                                          + " dB less accurate than the scalar cascade");
+}
+
+//==============================================================================
+namespace
+{
+    struct ParallelResult
+    {
+        bool accepted = false;
+        double estimatedErrorDb = 0.0;
+        double cascadeSamplesPerSecond = 0.0, blockSamplesPerSecond = 0.0, parallelSamplesPerSecond = 0.0;
+
+        /** Largest difference from the chain run in double, relative to the
+            output's peak.
+        */
+        double cascadeErrorDb = -400.0, parallelErrorDb = -400.0;
+    };
+}
+
+/** Designs the parallel form of chain and, if it is accepted, times it
+    against Cascade and BlockCascade on numSamples of mono noise.
+*/
+static ParallelResult runParallelBenchmark (const ChainCoefficients& chain, double sampleRate, int numSamples)
+{
+    ParallelResult result;
+    ParallelCoefficients parallel;
+    result.accepted = ParallelForm::design (chain, sampleRate, parallel);
+    result.estimatedErrorDb = parallel.errorDb;
+
+    std::vector<float> input ((size_t) numSamples), output;
+    juce::Random random (1);
+
+    for (auto& sample : input)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    std::vector<double> reference (input.begin(), input.end());
+    processInDouble (chain, reference.data(), numSamples);
+
+    double peak = 0.0;
+
+    for (auto sample : reference)
+        peak = juce::jmax (peak, std::abs (sample));
+
+    const auto timeRender = [&] (auto&& process, double* errorDb)
+    {
+        output = input;
+        const auto start = juce::Time::getHighResolutionTicks();
+        process (output.data(), numSamples);
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        if (errorDb != nullptr)
+        {
+            double maxError = 0.0;
+
+            for (size_t i = 0; i < output.size(); ++i)
+                maxError = juce::jmax (maxError, std::abs ((double) output[i] - reference[i]));
+
+            *errorDb = juce::Decibels::gainToDecibels (maxError / juce::jmax (1.0e-9, peak), -400.0);
+        }
+
+        return numSamples / juce::jmax (1.0e-9, seconds);
+    };
+
+    Cascade cascade;
+    cascade.setCoefficients (chain);
+    result.cascadeSamplesPerSecond = timeRender ([&] (float* samples, int n) { cascade.process (samples, n); }, &result.cascadeErrorDb);
+
+    BlockCascade blockCascade;
+    blockCascade.setCoefficients (chain);
+    result.blockSamplesPerSecond = timeRender ([&] (float* samples, int n) { blockCascade.process (samples, n); }, nullptr);
+
+    // Run even when rejected, so the numbers show why.
+    ParallelChain parallelChain;
+    parallelChain.setCoefficients (parallel);
+    parallelChain.reset();
+    result.parallelSamplesPerSecond = timeRender ([&] (float* samples, int n) { parallelChain.process (samples, n); }, &result.parallelErrorDb);
+
+    return result;
+}
+static void benchParallelCommand (const juce::ArgumentList& args)
+{
+    const auto sampleRate = args.containsOption ("--sample-rate") ? juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue()) : 48000.0;
+    const auto numSamples = args.containsOption ("--samples") ? juce::jmax (4096, args.getValueForOption ("--samples").getIntValue()) : 1 << 22;
+    const auto chain = designChain (parseFilterSet (args), sampleRate);
+    const auto result = runParallelBenchmark (chain, sampleRate, numSamples);
+
+    std::cout << "Parallel form, " << chain.numLowCut + 1 + chain.numHighCut << " sections at " << sampleRate << " Hz: "
+              << (result.accepted ? "accepted" : "rejected") << ", estimated error "
+              << juce::String (result.estimatedErrorDb, 1) << " dB (bound " << juce::String (ParallelForm::errorBoundDb, 0) << " dB)" << std::endl
+              << "  parallel: " << juce::String (result.parallelSamplesPerSecond * 1.0e-6, 1) << " M samples/s, error "
+              << juce::String (result.parallelErrorDb, 1) << " dB" << std::endl
+              << "  cascade:  " << juce::String (result.cascadeSamplesPerSecond * 1.0e-6, 1) << " M samples/s, error "
+              << juce::String (result.cascadeErrorDb, 1) << " dB" << std::endl
+              << "  block (" << BlockCascade::getName (BlockCascade::getBestInstructionSet()) << "): "
+              << juce::String (result.blockSamplesPerSecond * 1.0e-6, 1) << " M samples/s" << std::endl;
+}
+
+//==============================================================================
+namespace
+{
+    struct WorkersResult
+    {
+        int numChannels = 0, numThreads = 0;
+        double microsecondsPerBlock = 0.0;
+
+        /** Share of the block's real-time budget, 1 being all of it. */
+        double budgetUsed = 0.0;
+
+        /** Against one thread on the same number of channels. */
+        double speedUp = 1.0;
+    };
+}
+
+/** Filters numBlocks blocks of noise on 8, 16, 32 and 64 channels with
+    the chain, split over 1 to maxThreads threads (the caller counting
+    as one), the same way the plugin splits its channels.
+*/
+static std::vector<WorkersResult> runWorkersBenchmark (const ChainCoefficients& chain, double sampleRate,
+                                                       int blockSize, int numBlocks, int maxThreads)
+{
+    std::vector<WorkersResult> results;
+    juce::Random random (1);
+
+    for (auto numChannels : { 8, 16, 32, 64 })
+    {
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        std::vector<Cascade> cascades ((size_t) numChannels);
+
+        for (auto& cascade : cascades)
+            cascade.setCoefficients (chain);
+
+        struct Job
+        {
+            Cascade* cascades;
+            float* const* channels;
+            int numChannels, numTasks, numSamples;
+        };
+
+        const WorkerPool::Task filter = [] (void* context, int taskIndex) noexcept
+        {
+            const auto& job = *static_cast<const Job*> (context);
+            const auto group = WorkerPool::getGroup (job.numChannels, job.numTasks, taskIndex);
+
+            for (auto ch = group.getStart(); ch < group.getEnd(); ++ch)
+                job.cascades[ch].process (job.channels[ch], job.numSamples);
+        };
+
+        double oneThreadMicros = 0.0;
+
+        for (int numThreads = 1; numThreads <= maxThreads; ++numThreads)
+        {
+            WorkerPool pool;
+            pool.start (numThreads - 1, blockSize, sampleRate);
+
+            Job job { cascades.data(), buffer.getArrayOfWritePointers(), numChannels, juce::jmin (numChannels, numThreads), blockSize };
+
+            // A few blocks first, so that every thread is up and running.
+            for (int i = 0; i < 16; ++i)
+                pool.run (job.numTasks, filter, &job);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numBlocks; ++i)
+                pool.run (job.numTasks, filter, &job);
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+            WorkersResult result;
+            result.numChannels = numChannels;
+            result.numThreads = numThreads;
+            result.microsecondsPerBlock = seconds * 1.0e6 / numBlocks;
+            result.budgetUsed = result.microsecondsPerBlock * 1.0e-6 / (blockSize / sampleRate);
+
+            if (numThreads == 1)
+                oneThreadMicros = result.microsecondsPerBlock;
+
+            result.speedUp = oneThreadMicros / juce::jmax (1.0e-9, result.microsecondsPerBlock);
+            results.push_back (result);
+        }
+    }
+
+    return results;
+}
+static void benchWorkersCommand (const juce::ArgumentList& args)
+{
+    const auto sampleRate = args.containsOption ("--sample-rate") ? juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue()) : 48000.0;
+    const auto blockSize = args.containsOption ("--block-size") ? juce::jlimit (16, 8192, args.getValueForOption ("--block-size").getIntValue()) : 128;
+    const auto numBlocks = args.containsOption ("--blocks") ? juce::jmax (1, args.getValueForOption ("--blocks").getIntValue()) : 5000;
+    const auto maxThreads = args.containsOption ("--max-threads") ? juce::jlimit (1, 64, args.getValueForOption ("--max-threads").getIntValue())
+                                                                  : juce::jlimit (1, 8, juce::SystemStats::getNumCpus());
+    const auto chain = designChain (parseFilterSet (args), sampleRate);
+
+    std::cout << "Blocks of " << blockSize << " samples at " << sampleRate << " Hz ("
+              << juce::String (blockSize / sampleRate * 1.0e6, 0) << " us budget), "
+              << juce::SystemStats::getNumCpus() << " cores:" << std::endl;
+
+    for (auto& result : runWorkersBenchmark (chain, sampleRate, blockSize, numBlocks, maxThreads))
+        std::cout << "  " << juce::String (result.numChannels).paddedLeft (' ', 2) << " channels, "
+                  << result.numThreads << (result.numThreads == 1 ? " thread:  " : " threads: ")
+                  << juce::String (result.microsecondsPerBlock, 1).paddedLeft (' ', 7) << " us/block, "
+                  << juce::String (result.budgetUsed * 100.0, 1).paddedLeft (' ', 5) << "% of budget, "
+                  << juce::String (result.speedUp, 2) << "x" << std::endl;
+}
+
+//==============================================================================
+void addBenchmarkCommands (juce::ConsoleApplication& app)
+{
+    app.addCommand ({ "--bench-denormals",
+                      "--bench-denormals [--block-size=<n>] [--seconds=<s>] [--sample-rate=<Hz>] [EQ options]",
+                      "Times the EQ's silent tail after a loud transient, with and without the anti-denormal offset.",
+                      juce::String ("Filters 100 ms of full-scale noise and then --seconds (default 20) of silence in blocks "
+                                    "of --block-size (default 128), with denormals enabled, and prints the median time per "
+                                    "block over each and over the slowest 100 ms of silence. The exit code is non-zero "
+                                    "if the plugin's cascade is more than 1.5 times as slow there as on the noise. Steep "
+                                    "cuts, such as --low-cut-slope=96 --high-cut-slope=96, show the difference best.\n\n")
+                        + filterSetHelp,
+                      benchDenormalsCommand });
+
+    app.addCommand ({ "--bench-telemetry",
+                      "--bench-telemetry [--block-size=<n>] [--blocks=<n>] [EQ options]",
+                      "Measures what the per-instance telemetry adds to processBlock.",
+                      juce::String ("Runs --blocks (default 20000) stereo blocks of noise of --block-size (default 128) "
+                                    "through the plugin, then times the telemetry calls processBlock makes per block on "
+                                    "their own, and prints them as a share of the rest of the block. The exit code is "
+                                    "non-zero if that is 1% or more.\n\n")
+                        + filterSetHelp,
+                      benchTelemetryCommand });
+
+    app.addCommand ({ "--bench-crossover",
+                      "--bench-crossover [--samples=<n>] [EQ options]",
+                      "Times the crossover's fused band cascades against running it a section at a time.",
+                      juce::String ("Noise is split into three bands in blocks of 32 to 4096 samples both ways, --samples "
+                                    "(default 1M) at each size. The splits are at the low and high cut frequencies and slopes. "
+                                    "All three bands must match exactly; the exit code is non-zero if they don't.\n\n")
+                        + filterSetHelp,
+                      benchCrossoverCommand });
+
+    app.addCommand ({ "--bench-parameters",
+                      "--bench-parameters [--reads=<n>]",
+                      "Times reading the EQ settings by parameter ID against the processor's snapshot.",
+                      "processBlock used to look up all seven parameters by name on every block; it now reads them "
+                      "from a seqlocked snapshot. This prints the cost of one block's read both ways.",
+                      benchParametersCommand });
+
+    app.addCommand ({ "--bench-cascade",
+                      "--bench-cascade [--samples=<n>] [EQ options]",
+                      "Times the fused cascade the plugin runs against the ProcessorChain it replaced.",
+                      juce::String ("Noise is filtered in blocks of 32 to 4096 samples both ways, --samples (default 1M) at each "
+                                    "size. The two outputs must match exactly; the exit code is non-zero if they don't. Use "
+                                    "--low-cut-slope=96 --high-cut-slope=96 to run all seventeen sections.\n\n")
+                        + filterSetHelp,
+                      benchCascadeCommand });
+
+    app.addCommand ({ "--bench-mono",
+                      "--bench-mono [--samples=<n>] [--sample-rate=<Hz>] [EQ options]",
+                      "Times the offline renderer's block kernel against the scalar cascade on one channel.",
+                      juce::String ("Noise is filtered by the scalar cascade and by the block kernel for each instruction set "
+                                    "the CPU has (generic, AVX2, AVX-512), --samples (default 4M) at a time. Both are compared "
+                                    "with the same chain run in double; the exit code is non-zero if the block kernel is more "
+                                    "than 6 dB further off than the scalar one.\n\n")
+                        + filterSetHelp,
+                      benchMonoCommand });
+
+    app.addCommand ({ "--bench-parallel",
+                      "--bench-parallel [--samples=<n>] [--sample-rate=<Hz>] [EQ options]",
+                      "Designs the EQ in parallel form and times it against the cascade on one channel.",
+                      juce::String ("Prints whether the parallel form was accepted and its estimated error, then filters "
+                                    "--samples (default 4M) of noise with it, the scalar cascade and the block kernel. The "
+                                    "errors are against the same chain run in double. The parallel form is rejected when "
+                                    "poles sit too close together, as with a low and high cut at nearly the same frequency, "
+                                    "and --render --parallel then falls back to the cascade.\n\n")
+                        + filterSetHelp,
+                      benchParallelCommand });
+
+    app.addCommand ({ "--bench-workers",
+                      "--bench-workers [--block-size=<n>] [--blocks=<n>] [--max-threads=<n>] [--sample-rate=<Hz>] [EQ options]",
+                      "Times the plugin's worker threads on 8 to 64 channels.",
+                      juce::String ("Each channel count is filtered --blocks (default 5000) times in blocks of --block-size "
+                                    "(default 128), split over 1 to --max-threads threads (default: the number of cores, up "
+                                    "to 8) the way processBlock splits them with VONIC_WORKER_THREADS set. Prints the time "
+                                    "per block, the share of the real-time budget and the speed-up over one thread.\n\n")
+                        + filterSetHelp,
+                      benchWorkersCommand });
+}
+
+#endif
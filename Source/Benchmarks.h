@@ -0,0 +1,27 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+
+    The --bench-* commands, which time the plugin's kernels against the
+    code they replaced and check that the two agree. They are only worth
+    having in a build that is going to be profiled, so they are compiled
+    out of the plugin unless it is built with VONIC_BENCHMARKS=1.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef VONIC_BENCHMARKS
+ #define VONIC_BENCHMARKS 0
+#endif
+
+#if VONIC_BENCHMARKS
+
+/** Adds the --bench-* commands to the standalone build's command line. */
+void addBenchmarkCommands (juce::ConsoleApplication& app);
+
+#endif
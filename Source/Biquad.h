@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    Biquad.h
+
+    Second order section used by the cut and peak stages in place of
+    juce::dsp::IIR::Filter<float>. The state update carries a tiny DC
+    offset so that decaying tails never fall into the denormal range, even
+    when the host does not honour FTZ/DAZ, and a section whose state blows
+    up resets itself instead of poisoning the rest of the chain.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Normalised (a0 == 1) biquad coefficients. Defaults to a pass-through. */
+struct SectionCoefficients
+{
+    float b0 = 1.f, b1 = 0.f, b2 = 0.f, a1 = 0.f, a2 = 0.f;
+};
+
+class Biquad
+{
+public:
+    using NumericType = float;
+
+    SectionCoefficients coefficients;
+
+    void prepare (const juce::dsp::ProcessSpec&) noexcept { reset(); }
+
+    void reset() noexcept { s1 = s2 = 0.f; }
+
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        auto&& inputBlock  = context.getInputBlock();
+        auto&& outputBlock = context.getOutputBlock();
+
+        jassert (inputBlock.getNumChannels() == 1);
+        jassert (outputBlock.getNumChannels() == 1);
+
+        const auto numSamples = (int) outputBlock.getNumSamples();
+
+        if (context.isBypassed)
+        {
+            if (context.usesSeparateInputAndOutputBlocks())
+                outputBlock.copyFrom (inputBlock);
+
+            return;
+        }
+
+        processSamples (inputBlock.getChannelPointer (0), outputBlock.getChannelPointer (0), numSamples);
+    }
+
+    /** Raw-pointer entry point for code that does not go through a ProcessorChain.
+        in and out may be the same buffer.
+    */
+    void processSamples (const float* in, float* out, int numSamples) noexcept
+    {
+        const auto [b0, b1, b2, a1, a2] = coefficients;
+        auto lv1 = s1, lv2 = s2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = in[i];
+            const auto y = b0 * x + lv1;
+            lv1 = b1 * x - a1 * y + lv2 + antiDenormal;
+            lv2 = b2 * x - a2 * y;
+            out[i] = y;
+        }
+
+        // A NaN/Inf in the state would otherwise ring forever and leak into every
+        // following section. Drop this block's output and restart just this one.
+        if (! (std::isfinite (lv1) && std::isfinite (lv2)))
+        {
+            juce::FloatVectorOperations::clear (out, numSamples);
+            lv1 = lv2 = 0.f;
+            ++numResets;
+        }
+
+        s1 = lv1;
+        s2 = lv2;
+    }
+
+    /** How many times processSamples() has had to throw its state away. Not
+        cleared by reset(), so callers can keep track of it with deltas.
+    */
+    juce::uint32 getNumResets() const noexcept { return numResets; }
+
+    // Around -400 dBFS: inaudible, but keeps the recursion well above FLT_MIN.
+    static constexpr float antiDenormal = 1.0e-20f;
+
+private:
+    float s1 = 0.f, s2 = 0.f;
+    juce::uint32 numResets = 0;
+
+    JUCE_LEAK_DETECTOR (Biquad)
+};
@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+    BlockCascade.cpp
+
+  ==============================================================================
+*/
+
+#include "BlockCascade.h"
+
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define VONIC_BLOCK_CASCADE_X86 1
+#else
+ #define VONIC_BLOCK_CASCADE_X86 0
+#endif
+
+// The kernels are always inlined into their callers, so whether a vector
+// argument would be passed differently with AVX on is neither here nor there.
+JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wpsabi")
+
+struct BlockCascade::Kernels
+{
+    // GCC and Clang's vector extension rather than SIMDRegister, so that the
+    // same code comes out as whatever width the function is compiled for.
+    template <int Width>
+    struct Lanes
+    {
+        typedef float Type __attribute__ ((vector_size (Width * sizeof (float))));
+    };
+
+    template <int Width>
+    static forcedinline typename Lanes<Width>::Type load (const float* source) noexcept
+    {
+        typename Lanes<Width>::Type lanes;
+        std::memcpy (&lanes, source, sizeof (lanes));
+        return lanes;
+    }
+
+    /** Runs every section over samples, one section at a time across a
+        tile that stays in L1, Width samples per step.
+    */
+    template <int Width>
+    static forcedinline juce::uint32 processSections (Section* sections, int numSections, float* samples, int numSamples) noexcept
+    {
+        constexpr int tileSize = 1024;
+        juce::uint32 numResets = 0;
+
+        for (int tileStart = 0; tileStart < numSamples; tileStart += tileSize)
+        {
+            auto* tile = samples + tileStart;
+            const auto tileLength = juce::jmin (tileSize, numSamples - tileStart);
+            auto poisoned = false;
+
+            for (int k = 0; k < numSections; ++k)
+            {
+                auto& section = sections[k];
+                const auto [b0, b1, b2, a1, a2] = section.coefficients;
+                auto s1 = section.s1, s2 = section.s2;
+                int i = 0;
+
+                for (; i + Width <= tileLength; i += Width)
+                {
+                    const auto x = load<Width> (tile + i);
+
+                    // First the outputs as if the state going in were zero,
+                    // which doesn't wait for the previous step at all.
+                    auto y = load<Width> (section.response[0]) * x[0] + load<Width> (section.fromOffset);
+
+                    for (int j = 1; j < Width; ++j)
+                        y += load<Width> (section.response[j]) * x[j];
+
+                    // Biquad's own update over the last two samples gives the
+                    // input's share of the next state. The state's own share is
+                    // the 2 x 2 transition over the whole step, which is all
+                    // that has to wait for the previous step.
+                    const auto previous = b2 * x[Width - 2] - a2 * y[Width - 2];
+                    const auto u1 = b1 * x[Width - 1] - a1 * y[Width - 1] + previous + Biquad::antiDenormal;
+                    const auto u2 = b2 * x[Width - 1] - a2 * y[Width - 1];
+
+                    y += load<Width> (section.fromState1) * s1 + load<Width> (section.fromState2) * s2;
+                    std::memcpy (tile + i, &y, sizeof (y));
+
+                    const auto next1 = section.transition[0][0] * s1 + section.transition[0][1] * s2 + u1;
+                    s2 = section.transition[1][0] * s1 + section.transition[1][1] * s2 + u2;
+                    s1 = next1;
+                }
+
+                // Only the very end of the buffer can have a partial step.
+                for (; i < tileLength; ++i)
+                {
+                    const auto x = tile[i];
+                    const auto y = b0 * x + s1;
+                    s1 = b1 * x - a1 * y + s2 + Biquad::antiDenormal;
+                    s2 = b2 * x - a2 * y;
+                    tile[i] = y;
+                }
+
+                if (poisoned || ! (std::isfinite (s1) && std::isfinite (s2)))
+                {
+                    poisoned = true;
+                    s1 = s2 = 0.f;
+                    ++numResets;
+                }
+
+                section.s1 = s1;
+                section.s2 = s2;
+            }
+
+            if (poisoned)
+                juce::FloatVectorOperations::clear (tile, tileLength);
+        }
+
+        return numResets;
+    }
+
+    static juce::uint32 processGeneric (Section* sections, int numSections, float* samples, int numSamples) noexcept
+    {
+        return processSections<4> (sections, numSections, samples, numSamples);
+    }
+
+   #if VONIC_BLOCK_CASCADE_X86
+    __attribute__ ((target ("avx2")))
+    static juce::uint32 processAvx2 (Section* sections, int numSections, float* samples, int numSamples) noexcept
+    {
+        return processSections<8> (sections, numSections, samples, numSamples);
+    }
+
+    __attribute__ ((target ("avx512f")))
+    static juce::uint32 processAvx512 (Section* sections, int numSections, float* samples, int numSamples) noexcept
+    {
+        return processSections<16> (sections, numSections, samples, numSamples);
+    }
+   #endif
+};
+
+JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+
+//==============================================================================
+BlockCascade::InstructionSet BlockCascade::getBestInstructionSet() noexcept
+{
+    for (auto candidate : { InstructionSet::avx512, InstructionSet::avx2 })
+        if (isSupported (candidate))
+            return candidate;
+
+    return InstructionSet::generic;
+}
+
+bool BlockCascade::isSupported (InstructionSet set) noexcept
+{
+    switch (set)
+    {
+       #if VONIC_BLOCK_CASCADE_X86
+        case InstructionSet::avx2:    return juce::SystemStats::hasAVX2();
+        case InstructionSet::avx512:  return juce::SystemStats::hasAVX512F();
+       #else
+        case InstructionSet::avx2:
+        case InstructionSet::avx512:  return false;
+       #endif
+        case InstructionSet::generic: return true;
+    }
+
+    return false;
+}
+
+int BlockCascade::getBlockWidth (InstructionSet set) noexcept
+{
+    switch (set)
+    {
+        case InstructionSet::avx2:    return 8;
+        case InstructionSet::avx512:  return 16;
+        case InstructionSet::generic: break;
+    }
+
+    return 4;
+}
+
+const char* BlockCascade::getName (InstructionSet set) noexcept
+{
+    switch (set)
+    {
+        case InstructionSet::avx2:    return "AVX2";
+        case InstructionSet::avx512:  return "AVX-512";
+        case InstructionSet::generic: break;
+    }
+
+    return "generic";
+}
+
+BlockCascade::BlockCascade (InstructionSet set)
+    : instructionSet (isSupported (set) ? set : InstructionSet::generic),
+      blockWidth (getBlockWidth (instructionSet))
+{
+}
+
+//==============================================================================
+// Runs one step of a section in double from the given state, recording the
+// outputs and the state left at the end, which is all the block form needs.
+static void runStep (const SectionCoefficients& c, double s1, double s2, const double* x, bool withOffset,
+                     int width, double* y, double* finalState = nullptr)
+{
+    const auto offset = withOffset ? (double) Biquad::antiDenormal : 0.0;
+
+    for (int n = 0; n < width; ++n)
+    {
+        y[n] = c.b0 * x[n] + s1;
+        s1 = c.b1 * x[n] - c.a1 * y[n] + s2 + offset;
+        s2 = c.b2 * x[n] - c.a2 * y[n];
+    }
+
+    if (finalState != nullptr)
+    {
+        finalState[0] = s1;
+        finalState[1] = s2;
+    }
+}
+
+void BlockCascade::setCoefficients (const ChainCoefficients& chain) noexcept
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> active;
+    numSections = getActiveSections (chain, active);
+
+    double zeros[maxBlockWidth] {}, unit[maxBlockWidth] {}, y[maxBlockWidth], state[2];
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        auto& section = sections[(size_t) k];
+        const auto& c = active[(size_t) k];
+        section.coefficients = c;
+
+        const auto store = [&] (float* row)
+        {
+            for (int n = 0; n < blockWidth; ++n)
+                row[n] = (float) y[n];
+        };
+
+        for (int j = 0; j < blockWidth; ++j)
+        {
+            unit[j] = 1.0;
+            runStep (c, 0.0, 0.0, unit, false, blockWidth, y);
+            store (section.response[j]);
+            unit[j] = 0.0;
+        }
+
+        runStep (c, 1.0, 0.0, zeros, false, blockWidth, y, state);
+        store (section.fromState1);
+        section.transition[0][0] = (float) state[0];
+        section.transition[1][0] = (float) state[1];
+
+        runStep (c, 0.0, 1.0, zeros, false, blockWidth, y, state);
+        store (section.fromState2);
+        section.transition[0][1] = (float) state[0];
+        section.transition[1][1] = (float) state[1];
+
+        runStep (c, 0.0, 0.0, zeros, true, blockWidth, y);
+        store (section.fromOffset);
+    }
+}
+
+void BlockCascade::reset() noexcept
+{
+    for (auto& section : sections)
+        section.s1 = section.s2 = 0.f;
+}
+
+void BlockCascade::process (float* samples, int numSamples) noexcept
+{
+    switch (instructionSet)
+    {
+       #if VONIC_BLOCK_CASCADE_X86
+        case InstructionSet::avx2:    numResets += Kernels::processAvx2 (sections.data(), numSections, samples, numSamples); return;
+        case InstructionSet::avx512:  numResets += Kernels::processAvx512 (sections.data(), numSections, samples, numSamples); return;
+       #else
+        case InstructionSet::avx2:
+        case InstructionSet::avx512:
+       #endif
+        case InstructionSet::generic: break;
+    }
+
+    numResets += Kernels::processGeneric (sections.data(), numSections, samples, numSamples);
+}
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    BlockCascade.h
+
+    The EQ for a single channel, several consecutive samples at a time.
+    Each biquad is rewritten in block state-space form: a block of W outputs
+    is a W x W matrix times the W inputs plus a W x 2 matrix times the state
+    going in, which is all independent multiply-adds instead of a recurrence.
+    The state going out is a 2 x 2 matrix times the state going in, plus the
+    inputs' share, so only that short step is serial.
+
+    W is the float width of the widest vector unit the CPU has: 16 with
+    AVX-512, 8 with AVX2, otherwise 4. juce::dsp::SIMDRegister only goes up
+    to SSE, so the kernel is plain loops over W that the compiler vectorises,
+    built once per instruction set and picked at run time.
+
+    The output matches Cascade to within float rounding, not bit for bit.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+class BlockCascade
+{
+public:
+    enum class InstructionSet { generic, avx2, avx512 };
+
+    /** The widest instruction set this CPU (and this build) can run. */
+    static InstructionSet getBestInstructionSet() noexcept;
+    static bool isSupported (InstructionSet) noexcept;
+    static int getBlockWidth (InstructionSet) noexcept;
+    static const char* getName (InstructionSet) noexcept;
+
+    explicit BlockCascade (InstructionSet instructionSet = getBestInstructionSet());
+
+    void setCoefficients (const ChainCoefficients& chain) noexcept;
+    void reset() noexcept;
+    void process (float* samples, int numSamples) noexcept;
+
+    /** As Cascade::getNumResets(). */
+    juce::uint32 getNumResets() const noexcept { return numResets; }
+
+private:
+    static constexpr int maxBlockWidth = 16;
+
+    struct alignas (64) Section
+    {
+        // response[j][i] is output i's response to input j; fromState1/2
+        // are the outputs' responses to each state variable going in, and
+        // transition takes the state going in to the state going out.
+        float response[maxBlockWidth][maxBlockWidth];
+        float fromState1[maxBlockWidth], fromState2[maxBlockWidth];
+        float fromOffset[maxBlockWidth];
+        float transition[2][2];
+        SectionCoefficients coefficients;
+        float s1 = 0.f, s2 = 0.f;
+    };
+
+    struct Kernels;
+
+    InstructionSet instructionSet;
+    int blockWidth;
+    std::array<Section, ChainCoefficients::maxSections> sections;
+    int numSections = 0;
+    juce::uint32 numResets = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BlockCascade)
+};
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    ChainDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainDesign.h"
+
+static SectionCoefficients toSection (const juce::dsp::IIR::Coefficients<float>& coefficients)
+{
+    const auto* c = coefficients.getRawCoefficients();
+
+    // The Butterworth designers lead odd orders with a first-order section.
+    if (coefficients.getFilterOrder() == 1)
+        return { c[0], c[1], 0.f, c[2], 0.f };
+
+    jassert (coefficients.getFilterOrder() == 2);
+    return { c[0], c[1], c[2], c[3], c[4] };
+}
+
+// The parameter ranges go up to 20 kHz, which is past Nyquist at 32 kHz and below.
+static float limitToNyquist (float frequency, double sampleRate)
+{
+    return juce::jmin (frequency, (float) (sampleRate * 0.49));
+}
+
+SectionCoefficients designPeak (float frequency, float quality, float gainDecibels, double sampleRate)
+{
+    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,limitToNyquist(frequency,sampleRate),quality,juce::Decibels::decibelsToGain(gainDecibels));
+    return toSection (*peakCoefficients);
+}
+
+int designLowCut (float frequency, Gradient slope, double sampleRate, std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections)
+{
+    auto lowCutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(limitToNyquist(frequency,sampleRate),sampleRate,getCutOrder(slope));
+    for (int i = 0; i < lowCutCoefficients.size(); ++i)
+        sections[(size_t) i] = toSection (*lowCutCoefficients[i]);
+    return lowCutCoefficients.size();
+}
+
+int designHighCut (float frequency, Gradient slope, double sampleRate, std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections)
+{
+    auto highCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(limitToNyquist(frequency,sampleRate),sampleRate,getCutOrder(slope));
+    for (int i = 0; i < highCutCoefficients.size(); ++i)
+        sections[(size_t) i] = toSection (*highCutCoefficients[i]);
+    return highCutCoefficients.size();
+}
+
+ChainCoefficients designChain (const FilterSet& settings, double sampleRate)
+{
+    ChainCoefficients chain;
+    chain.peak = designPeak (settings.peakFreq, settings.peakQual, settings.peakGain, sampleRate);
+    chain.numLowCut = designLowCut (settings.lowCutFreq, settings.lowCutSlope, sampleRate, chain.lowCut);
+    chain.numHighCut = designHighCut (settings.highCutFreq, settings.highCutSlope, sampleRate, chain.highCut);
+    return chain;
+}
+
+int getActiveSections (const ChainCoefficients& chain, std::array<SectionCoefficients, ChainCoefficients::maxSections>& sections) noexcept
+{
+    int numSections = 0;
+
+    for (int i = 0; i < chain.numLowCut; ++i)
+        sections[(size_t) numSections++] = chain.lowCut[(size_t) i];
+
+    sections[(size_t) numSections++] = chain.peak;
+
+    for (int i = 0; i < chain.numHighCut; ++i)
+        sections[(size_t) numSections++] = chain.highCut[(size_t) i];
+
+    return numSections;
+}
+
+double getResponseDb (const ChainCoefficients& chain, double frequency, double sampleRate)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+
+    const auto z1 = std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+    const auto z2 = z1 * z1;
+    double magnitudeSquared = 1.0;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& c = sections[(size_t) i];
+        const auto numerator = (double) c.b0 + (double) c.b1 * z1 + (double) c.b2 * z2;
+        const auto denominator = 1.0 + (double) c.a1 * z1 + (double) c.a2 * z2;
+        magnitudeSquared *= std::norm (numerator) / std::norm (denominator);
+    }
+
+    return 10.0 * std::log10 (juce::jmax (magnitudeSquared, 1.0e-40));
+}
+
+void processInDouble (const ChainCoefficients& chain, double* samples, int numSamples) noexcept
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto& c = sections[(size_t) k];
+        double s1 = 0.0, s2 = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            const auto y = c.b0 * x + s1;
+            s1 = c.b1 * x - c.a1 * y + s2;
+            s2 = c.b2 * x - c.a2 * y;
+            samples[i] = y;
+        }
+    }
+}
+
+//==============================================================================
+void Cascade::setCoefficients (const ChainCoefficients& chain) noexcept
+{
+    if (! hasSameSections (chain))
+    {
+        // The sections are laid out low cut, peak, high cut, so the state
+        // that is kept may have to move.
+        std::array<float, ChainCoefficients::maxSections> newS1 {}, newS2 {};
+
+        if (numLowCut >= 0)
+        {
+            const auto move = [&] (int from, int to, int count)
+            {
+                std::copy (s1.begin() + from, s1.begin() + from + count, newS1.begin() + to);
+                std::copy (s2.begin() + from, s2.begin() + from + count, newS2.begin() + to);
+            };
+
+            if (chain.numLowCut == numLowCut)
+                move (0, 0, numLowCut);
+
+            move (numLowCut, chain.numLowCut, 1);
+
+            if (chain.numHighCut == numHighCut)
+                move (numLowCut + 1, chain.numLowCut + 1, numHighCut);
+        }
+
+        s1 = newS1;
+        s2 = newS2;
+        numLowCut = chain.numLowCut;
+        numHighCut = chain.numHighCut;
+    }
+
+    numSections = getActiveSections (chain, sections);
+    kernel = getKernel (numSections);
+}
+
+void Cascade::setSections (const SectionCoefficients* newSections, int count) noexcept
+{
+    jassert (juce::isPositiveAndNotGreaterThan (count, ChainCoefficients::maxSections));
+
+    // Without stages to match up, there's no telling which state goes with
+    // which section once the count changes.
+    if (count != numSections || numLowCut >= 0)
+        reset();
+
+    numLowCut = numHighCut = -1;
+    numSections = count;
+    std::copy (newSections, newSections + count, sections.begin());
+    kernel = getKernel (numSections);
+}
+
+Cascade::Kernel Cascade::getKernel (int count) noexcept
+{
+    static constexpr auto kernels = makeKernels (std::make_index_sequence<(size_t) ChainCoefficients::maxSections>());
+
+    jassert (juce::isPositiveAndNotGreaterThan (count, ChainCoefficients::maxSections));
+    return count > 0 ? kernels[(size_t) count - 1] : nullptr;
+}
+
+void Cascade::reset() noexcept
+{
+    s1.fill (0.f);
+    s2.fill (0.f);
+}
+
+template <int NumSections>
+void Cascade::processFused (float* samples, int numSamples) noexcept
+{
+    // With the section count fixed at compile time, the inner loop unrolls
+    // and all of this stays in registers.
+    float b0[NumSections], b1[NumSections], b2[NumSections], a1[NumSections], a2[NumSections];
+    float lv1[NumSections], lv2[NumSections];
+
+    for (int k = 0; k < NumSections; ++k)
+    {
+        const auto& c = sections[(size_t) k];
+        b0[k] = c.b0;  b1[k] = c.b1;  b2[k] = c.b2;
+        a1[k] = c.a1;  a2[k] = c.a2;
+        lv1[k] = s1[(size_t) k];
+        lv2[k] = s2[(size_t) k];
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            const auto y = b0[k] * x + lv1[k];
+            lv1[k] = b1[k] * x - a1[k] * y + lv2[k] + Biquad::antiDenormal;
+            lv2[k] = b2[k] * x - a2[k] * y;
+            x = y;
+        }
+
+        samples[i] = x;
+    }
+
+    // Everything after a section that blew up has seen its output, so all of
+    // those restart and the block is dropped, as Biquad would do for each.
+    auto poisoned = false;
+
+    for (int k = 0; k < NumSections; ++k)
+    {
+        if (poisoned || ! (std::isfinite (lv1[k]) && std::isfinite (lv2[k])))
+        {
+            poisoned = true;
+            lv1[k] = lv2[k] = 0.f;
+            ++numResets;
+        }
+
+        s1[(size_t) k] = lv1[k];
+        s2[(size_t) k] = lv2[k];
+    }
+
+    if (poisoned)
+        juce::FloatVectorOperations::clear (samples, numSamples);
+}
+
+void Cascade::process (float* samples, int numSamples) noexcept
+{
+    // Only null before the first setCoefficients().
+    if (kernel != nullptr)
+        (this->*kernel) (samples, numSamples);
+}
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    ChainDesign.h
+
+    Turns a FilterSet into the raw biquad coefficients of the low-cut, peak
+    and high-cut stages. Shared by the plugin's MonoChain and anything else
+    that needs to run the same EQ without going through processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Biquad.h"
+
+/** Cut slopes, one Butterworth order (6 dB/oct) apart. */
+enum Gradient{
+  grad6,
+  grad12,
+  grad18,
+  grad24,
+  grad30,
+  grad36,
+  grad42,
+  grad48,
+  grad54,
+  grad60,
+  grad66,
+  grad72,
+  grad78,
+  grad84,
+  grad90,
+  grad96
+};
+constexpr int numGradients = grad96 + 1;
+struct FilterSet{
+  float peakFreq {0},peakGain{0},peakQual{1.f};
+  float lowCutFreq {0},highCutFreq {0};
+  Gradient lowCutSlope {Gradient::grad12},highCutSlope{Gradient::grad12};
+};
+
+inline bool operator== (const FilterSet& a, const FilterSet& b) noexcept
+{
+    return a.peakFreq == b.peakFreq && a.peakGain == b.peakGain && a.peakQual == b.peakQual
+        && a.lowCutFreq == b.lowCutFreq && a.highCutFreq == b.highCutFreq
+        && a.lowCutSlope == b.lowCutSlope && a.highCutSlope == b.highCutSlope;
+}
+
+inline bool operator!= (const FilterSet& a, const FilterSet& b) noexcept { return ! (a == b); }
+
+/** Every section the EQ can run, in processing order. Unused cut slots are
+    left at identity, so a chain can always run all of them if it wants to.
+*/
+struct ChainCoefficients
+{
+    static constexpr int maxCutSections = (numGradients + 1) / 2;
+    static constexpr int maxSections = 2 * maxCutSections + 1;
+
+    std::array<SectionCoefficients, maxCutSections> lowCut;
+    SectionCoefficients peak;
+    std::array<SectionCoefficients, maxCutSections> highCut;
+    int numLowCut = 0, numHighCut = 0;
+};
+
+/** Butterworth order of a cut stage at the given slope. */
+inline int getCutOrder (Gradient slope) noexcept { return (int) slope + 1; }
+inline int getDecibelsPerOctave (Gradient slope) noexcept { return 6 * getCutOrder (slope); }
+
+/** The slope nearest to decibelsPerOctave, within 6 to 96 dB/oct. */
+inline Gradient makeGradient (int decibelsPerOctave) noexcept
+{
+    return static_cast<Gradient> (juce::jlimit (0, numGradients - 1, (decibelsPerOctave + 3) / 6 - 1));
+}
+
+/** Number of sections a cut stage needs for the given slope. Odd orders
+    start with a first-order section, which is a biquad with b2 = a2 = 0.
+*/
+inline int getNumCutSections (Gradient slope) noexcept { return (getCutOrder (slope) + 1) / 2; }
+
+ChainCoefficients designChain (const FilterSet& settings, double sampleRate);
+
+/** The individual stages of designChain(), for callers that cache them. */
+SectionCoefficients designPeak (float frequency, float quality, float gainDecibels, double sampleRate);
+int designLowCut (float frequency, Gradient slope, double sampleRate, std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections);
+int designHighCut (float frequency, Gradient slope, double sampleRate, std::array<SectionCoefficients, ChainCoefficients::maxCutSections>& sections);
+
+/** Copies the sections that are actually in use into processing order and
+    returns how many there are.
+*/
+int getActiveSections (const ChainCoefficients& chain, std::array<SectionCoefficients, ChainCoefficients::maxSections>& sections) noexcept;
+
+/** Magnitude response of the active sections at one frequency, in dB. */
+double getResponseDb (const ChainCoefficients& chain, double frequency, double sampleRate);
+
+/** Runs the active sections over samples in double, from silence and with
+    no anti-denormal offset: the reference the float kernels are held to.
+*/
+void processInDouble (const ChainCoefficients& chain, double* samples, int numSamples) noexcept;
+
+//==============================================================================
+/** One channel of the EQ, running only the sections the current slopes need.
+
+    Each sample goes through every active section before the next one is
+    read, with the coefficients and state held in locals for the whole
+    block, so the buffer is read and written once instead of once per
+    section. The arithmetic is the same as Biquad's, sample for sample.
+
+    There is a kernel for every section count, 1 to maxSections, with the
+    count fixed at compile time; setCoefficients() picks the one to run, so
+    process() has nothing to decide and nothing to bypass.
+
+    Also usable as a ProcessorChain-style processor, which is how the
+    plugin's MonoChain runs it.
+*/
+class Cascade
+{
+public:
+    /** Keeps each section's state, as long as it is still the same section.
+        When a cut's slope changes, its sections are different filters and
+        start over from silence, while the peak and the other cut carry on.
+    */
+    void setCoefficients (const ChainCoefficients& chain) noexcept;
+
+    /** True if setCoefficients (chain) would keep all of the state, i.e. both
+        cuts have as many sections as they do now.
+    */
+    bool hasSameSections (const ChainCoefficients& chain) const noexcept
+    {
+        return chain.numLowCut == numLowCut && chain.numHighCut == numHighCut;
+    }
+
+    /** Runs these sections in this order instead of a chain's active ones.
+        There can be up to ChainCoefficients::maxSections of them. The state
+        is kept if there are as many as before, and cleared if not.
+    */
+    void setSections (const SectionCoefficients* newSections, int count) noexcept;
+
+    void reset() noexcept;
+    void process (float* samples, int numSamples) noexcept;
+
+    void prepare (const juce::dsp::ProcessSpec&) noexcept { reset(); }
+
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        auto&& outputBlock = context.getOutputBlock();
+        jassert (outputBlock.getNumChannels() == 1);
+
+        if (context.usesSeparateInputAndOutputBlocks())
+            outputBlock.copyFrom (context.getInputBlock());
+
+        if (! context.isBypassed)
+            process (outputBlock.getChannelPointer (0), (int) outputBlock.getNumSamples());
+    }
+
+    /** How many times a section has had to throw its state away, as with
+        Biquad::getNumResets(). Not cleared by reset().
+    */
+    juce::uint32 getNumResets() const noexcept { return numResets; }
+
+private:
+    template <int NumSections>
+    void processFused (float* samples, int numSamples) noexcept;
+
+    using Kernel = void (Cascade::*) (float*, int) noexcept;
+
+    template <size_t... Counts>
+    static constexpr std::array<Kernel, sizeof... (Counts)> makeKernels (std::index_sequence<Counts...>) noexcept
+    {
+        return { { &Cascade::processFused<(int) Counts + 1>... } };
+    }
+
+    static Kernel getKernel (int numSections) noexcept;
+
+    Kernel kernel = nullptr;
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    std::array<float, ChainCoefficients::maxSections> s1 {}, s2 {};
+    int numSections = 0;
+
+    // The chain's cut section counts, or -1 when setSections() set these.
+    int numLowCut = -1, numHighCut = -1;
+    juce::uint32 numResets = 0;
+};
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    ChainResponse.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainResponse.h"
+
+namespace ChainResponse
+{
+
+using Register = juce::dsp::SIMDRegister<double>;
+static constexpr int numLanes = (int) Register::SIMDNumElements;
+
+std::vector<double> makeLogFrequencies (int numPoints, double sampleRate, double lowest)
+{
+    std::vector<double> frequencies ((size_t) juce::jmax (0, numPoints));
+    const auto highest = sampleRate * 0.4999;
+
+    if (numPoints == 1)
+        frequencies[0] = lowest;
+
+    for (int i = 0; numPoints > 1 && i < numPoints; ++i)
+        frequencies[(size_t) i] = lowest * std::pow (highest / lowest, (double) i / (numPoints - 1));
+
+    return frequencies;
+}
+
+void getFrequencyResponse (const ChainCoefficients& chain, double sampleRate,
+                           const double* frequencies, std::complex<double>* response, int numPoints)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+    const auto radiansPerHz = juce::MathConstants<double>::twoPi / sampleRate;
+
+    alignas (sizeof (Register)) double cosines[numLanes], sines[numLanes];
+    alignas (sizeof (Register)) double numReal[numLanes], numImag[numLanes], denReal[numLanes], denImag[numLanes];
+
+    for (int start = 0; start < numPoints; start += numLanes)
+    {
+        const auto count = juce::jmin (numLanes, numPoints - start);
+
+        // Spare lanes in the last group evaluate DC and are thrown away.
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto w = lane < count ? frequencies[start + lane] * radiansPerHz : 0.0;
+            cosines[lane] = std::cos (w);
+            sines[lane] = std::sin (w);
+        }
+
+        // z^-1 = cos w - j sin w, and z^-2 is its square.
+        const auto z1Real = Register::fromRawArray (cosines);
+        const auto z1Imag = Register::expand (0.0) - Register::fromRawArray (sines);
+        const auto z2Real = z1Real * z1Real - z1Imag * z1Imag;
+        const auto z2Imag = z1Real * z1Imag * 2.0;
+
+        auto nr = Register::expand (1.0), ni = Register::expand (0.0);
+        auto dr = Register::expand (1.0), di = Register::expand (0.0);
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[(size_t) i];
+
+            const auto sectionNumReal = z1Real * (double) c.b1 + z2Real * (double) c.b2 + (double) c.b0;
+            const auto sectionNumImag = z1Imag * (double) c.b1 + z2Imag * (double) c.b2;
+            const auto sectionDenReal = z1Real * (double) c.a1 + z2Real * (double) c.a2 + 1.0;
+            const auto sectionDenImag = z1Imag * (double) c.a1 + z2Imag * (double) c.a2;
+
+            const auto nextNumReal = nr * sectionNumReal - ni * sectionNumImag;
+            ni = nr * sectionNumImag + ni * sectionNumReal;
+            nr = nextNumReal;
+
+            const auto nextDenReal = dr * sectionDenReal - di * sectionDenImag;
+            di = dr * sectionDenImag + di * sectionDenReal;
+            dr = nextDenReal;
+        }
+
+        nr.copyToRawArray (numReal);
+        ni.copyToRawArray (numImag);
+        dr.copyToRawArray (denReal);
+        di.copyToRawArray (denImag);
+
+        for (int lane = 0; lane < count; ++lane)
+            response[start + lane] = std::complex<double> (numReal[lane], numImag[lane])
+                                   / std::complex<double> (denReal[lane], denImag[lane]);
+    }
+}
+
+void getImpulseResponse (const ChainCoefficients& chain, double* impulse, int numSamples)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+    std::array<double, ChainCoefficients::maxSections> s1 {}, s2 {};
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        auto x = n == 0 ? 1.0 : 0.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[(size_t) i];
+            const auto y = c.b0 * x + s1[(size_t) i];
+            s1[(size_t) i] = c.b1 * x - c.a1 * y + s2[(size_t) i];
+            s2[(size_t) i] = c.b2 * x - c.a2 * y;
+            x = y;
+        }
+
+        impulse[n] = x;
+    }
+}
+
+double getTailLength (const ChainCoefficients& chain, double decibels)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+    const auto logLevel = decibels / 20.0 * std::log (10.0);
+    double length = 0.0;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        // The poles are the roots of z^2 + a1 z + a2; a first-order section
+        // has a2 = 0 and its one pole at -a1.
+        const auto a1 = (double) sections[(size_t) i].a1, a2 = (double) sections[(size_t) i].a2;
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+        const auto radius = discriminant < 0.0 ? std::sqrt (a2)
+                                               : (std::abs (a1) + std::sqrt (discriminant)) * 0.5;
+
+        // Poles at the origin (FIR sections) are over after a couple of
+        // samples, and a pole on or outside the unit circle never is.
+        if (radius < 1.0e-6)
+            length += 2.0;
+        else if (radius < 1.0)
+            length += logLevel / std::log (radius);
+    }
+
+    return length;
+}
+
+}
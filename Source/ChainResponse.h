@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    ChainResponse.h
+
+    What a chain does, worked out from its coefficients instead of by
+    running audio through it. The frequency response is evaluated a
+    SIMDRegister of frequencies at a time: the numerators and denominators
+    of every section are multiplied up separately, so there is only one
+    complex divide per frequency at the end.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+namespace ChainResponse
+{
+    /** numPoints frequencies evenly spaced in log frequency, from lowest up
+        to just below Nyquist.
+    */
+    std::vector<double> makeLogFrequencies (int numPoints, double sampleRate, double lowest = 10.0);
+
+    /** Complex response of the chain's active sections at each frequency,
+        in double precision from the float coefficients the chain runs with.
+    */
+    void getFrequencyResponse (const ChainCoefficients& chain, double sampleRate,
+                               const double* frequencies, std::complex<double>* response, int numPoints);
+
+    /** The first numSamples of the chain's impulse response, run in double
+        with no anti-denormal offset.
+    */
+    void getImpulseResponse (const ChainCoefficients& chain, double* impulse, int numSamples);
+
+    /** Roughly how many samples the chain rings for after its input stops,
+        until it is decibels below where it started: each section's slowest
+        pole decaying that far, added up over the sections. That errs long,
+        by 2 to 4 times for the cuts' Butterworth sections.
+    */
+    double getTailLength (const ChainCoefficients& chain, double decibels = -120.0);
+}
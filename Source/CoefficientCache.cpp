@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+#include "FastDesign.h"
+
+template <typename Type>
+static juce::uint32 toBits (Type value) noexcept
+{
+    static_assert (sizeof (Type) == sizeof (juce::uint32), "one word per value");
+    juce::uint32 bits;
+    std::memcpy (&bits, &value, sizeof (bits));
+    return bits;
+}
+
+static float toFloat (juce::uint32 bits) noexcept
+{
+    float value;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+// No real key has this in its first word, so empty slots never match.
+static constexpr juce::uint32 emptySlot = 0xffffffff;
+
+//==============================================================================
+juce::String CoefficientCache::Stats::toString() const
+{
+    return "Coefficient cache hit rate " + juce::String (getHitRate() * 100.0, 1) + "% of "
+         + juce::String (hits + misses) + " lookups, " + juce::String (evictions) + " evictions";
+}
+
+CoefficientCache& CoefficientCache::getInstance()
+{
+    static CoefficientCache instance;
+    return instance;
+}
+
+CoefficientCache::CoefficientCache()
+    : slots (new Slot[(size_t) numSlots])
+{
+    for (int i = 0; i < numSlots; ++i)
+    {
+        for (auto& word : slots[(size_t) i].words)
+            word.store (0, std::memory_order_relaxed);
+
+        slots[(size_t) i].words[0].store (emptySlot, std::memory_order_relaxed);
+    }
+}
+
+void CoefficientCache::packKey (const Key& key, Words& words) noexcept
+{
+    juce::uint64 rateBits;
+    std::memcpy (&rateBits, &key.sampleRate, sizeof (rateBits));
+
+    words[0] = (juce::uint32) key.stage | ((juce::uint32) key.slope << 8);
+    words[1] = toBits (key.frequency);
+    words[2] = toBits (key.quality);
+    words[3] = toBits (key.gain);
+    words[4] = (juce::uint32) rateBits;
+    words[5] = (juce::uint32) (rateBits >> 32);
+}
+
+size_t CoefficientCache::getSlotIndex (const Words& words) noexcept
+{
+    juce::uint64 hash = 0xcbf29ce484222325ull;
+
+    for (int i = 0; i < keyWords; ++i)
+        hash = (hash ^ words[(size_t) i]) * 0x9e3779b97f4a7c15ull;
+
+    return (size_t) (hash >> 32) & (size_t) (numSlots - 1);
+}
+
+bool CoefficientCache::lookup (const Key& key, Block& block) noexcept
+{
+    Words wanted;
+    packKey (key, wanted);
+    auto& slot = slots[getSlotIndex (wanted)];
+
+    const auto before = slot.sequence.load (std::memory_order_acquire);
+    Words found;
+
+    if ((before & 1) == 0)
+    {
+        for (size_t i = 0; i < found.size(); ++i)
+            found[i] = slot.words[i].load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        // An unchanged, even sequence means nobody wrote while we were copying.
+        if (slot.sequence.load (std::memory_order_relaxed) == before
+             && std::equal (wanted.begin(), wanted.begin() + keyWords, found.begin()))
+        {
+            block.numSections = (int) found[keyWords];
+
+            for (size_t s = 0; s < block.sections.size(); ++s)
+            {
+                const auto* w = found.data() + keyWords + 1 + 5 * s;
+                block.sections[s] = { toFloat (w[0]), toFloat (w[1]), toFloat (w[2]), toFloat (w[3]), toFloat (w[4]) };
+            }
+
+            hits.fetch_add (1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    misses.fetch_add (1, std::memory_order_relaxed);
+    return false;
+}
+
+void CoefficientCache::insert (const Key& key, const Block& block) noexcept
+{
+    Words words;
+    packKey (key, words);
+    words[keyWords] = (juce::uint32) block.numSections;
+
+    for (size_t s = 0; s < block.sections.size(); ++s)
+    {
+        const auto& c = block.sections[s];
+        auto* w = words.data() + keyWords + 1 + 5 * s;
+        w[0] = toBits (c.b0); w[1] = toBits (c.b1); w[2] = toBits (c.b2); w[3] = toBits (c.a1); w[4] = toBits (c.a2);
+    }
+
+    auto& slot = slots[getSlotIndex (words)];
+    auto sequence = slot.sequence.load (std::memory_order_relaxed);
+
+    // Odd means someone else is mid-write; their entry is as good as ours.
+    if ((sequence & 1) != 0 || ! slot.sequence.compare_exchange_strong (sequence, sequence + 1, std::memory_order_relaxed))
+        return;
+
+    std::atomic_thread_fence (std::memory_order_release);
+
+    if (slot.words[0].load (std::memory_order_relaxed) != emptySlot)
+        evictions.fetch_add (1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < words.size(); ++i)
+        slot.words[i].store (words[i], std::memory_order_relaxed);
+
+    slot.sequence.store (sequence + 2, std::memory_order_release);
+}
+
+CoefficientCache::Stats CoefficientCache::getStats() const noexcept
+{
+    Stats stats;
+    stats.hits = hits.load (std::memory_order_relaxed);
+    stats.misses = misses.load (std::memory_order_relaxed);
+    stats.evictions = evictions.load (std::memory_order_relaxed);
+    return stats;
+}
+
+//==============================================================================
+ChainCoefficients designChainCached (const FilterSet& settings, double sampleRate)
+{
+    auto& cache = CoefficientCache::getInstance();
+    ChainCoefficients chain;
+
+    // Blocks are reset before each design, so unused cut slots stay at
+    // identity just like designChain() leaves them.
+    CoefficientCache::Block block;
+
+    // Misses are filled in from FastDesign, which designs every stage in one
+    // pass without libm, so it runs at most once however many stages miss.
+    ChainCoefficients designed;
+    auto isDesigned = false;
+
+    const auto getDesigned = [&]() -> const ChainCoefficients&
+    {
+        if (! isDesigned)
+        {
+            designed = FastDesign::designChain (settings, sampleRate);
+            isDesigned = true;
+        }
+
+        return designed;
+    };
+
+    const CoefficientCache::Key peakKey { CoefficientCache::Stage::peak, 0, settings.peakFreq, settings.peakQual, settings.peakGain, sampleRate };
+
+    if (! cache.lookup (peakKey, block))
+    {
+        block = {};
+        block.numSections = 1;
+        block.sections[0] = getDesigned().peak;
+        cache.insert (peakKey, block);
+    }
+
+    chain.peak = block.sections[0];
+
+    const CoefficientCache::Key lowCutKey { CoefficientCache::Stage::lowCut, (int) settings.lowCutSlope, settings.lowCutFreq, 0.f, 0.f, sampleRate };
+
+    if (! cache.lookup (lowCutKey, block))
+    {
+        block = {};
+        block.numSections = getDesigned().numLowCut;
+        block.sections = getDesigned().lowCut;
+        cache.insert (lowCutKey, block);
+    }
+
+    chain.lowCut = block.sections;
+    chain.numLowCut = block.numSections;
+
+    const CoefficientCache::Key highCutKey { CoefficientCache::Stage::highCut, (int) settings.highCutSlope, settings.highCutFreq, 0.f, 0.f, sampleRate };
+
+    if (! cache.lookup (highCutKey, block))
+    {
+        block = {};
+        block.numSections = getDesigned().numHighCut;
+        block.sections = getDesigned().highCut;
+        cache.insert (highCutKey, block);
+    }
+
+    chain.highCut = block.sections;
+    chain.numHighCut = block.numSections;
+    return chain;
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+
+    Process-wide memo of designed filter stages, so that a session full of
+    instances with the same 80 Hz low cut only designs it once.
+
+    The table is a fixed array of slots, each guarded by a seqlock: readers
+    never wait or write shared state except for the hit/miss counters, and
+    a writer that finds its slot busy just skips the insert. A new entry
+    replaces whatever was in its slot, which keeps memory use fixed at
+    about 390 KB (2048 slots of 192 bytes).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+class CoefficientCache
+{
+public:
+    enum class Stage : juce::uint32 { peak, lowCut, highCut };
+
+    /** Everything a stage's design depends on. Fields a stage ignores should
+        be left at zero so that they don't split its entries.
+    */
+    struct Key
+    {
+        Stage stage = Stage::peak;
+        int slope = 0;
+        float frequency = 0.f, quality = 0.f, gain = 0.f;
+        double sampleRate = 0.0;
+    };
+
+    /** A designed stage. Peaks have one section, cuts up to maxCutSections. */
+    struct Block
+    {
+        int numSections = 0;
+        std::array<SectionCoefficients, ChainCoefficients::maxCutSections> sections;
+    };
+
+    struct Stats
+    {
+        juce::uint64 hits = 0, misses = 0, evictions = 0;
+
+        double getHitRate() const noexcept    { return hits + misses > 0 ? (double) hits / (double) (hits + misses) : 0.0; }
+        juce::String toString() const;
+    };
+
+    /** The one table for the whole process. Call it from the message thread
+        once before any audio thread does, so it isn't allocated there.
+    */
+    static CoefficientCache& getInstance();
+
+    /** Copies the entry for key into block and returns true, or returns false
+        if it isn't there. Lock-free and safe on the audio thread.
+    */
+    bool lookup (const Key& key, Block& block) noexcept;
+
+    /** Stores an entry, replacing whatever shared its slot. Lock-free, and
+        gives up rather than waiting if another thread is writing the slot.
+    */
+    void insert (const Key& key, const Block& block) noexcept;
+
+    Stats getStats() const noexcept;
+
+    static constexpr int numSlots = 2048;
+
+private:
+    CoefficientCache();
+
+    static constexpr int keyWords = 6;
+    static constexpr int valueWords = 1 + 5 * ChainCoefficients::maxCutSections;
+    using Words = std::array<juce::uint32, keyWords + valueWords>;
+
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence { 0 };
+        std::array<std::atomic<juce::uint32>, keyWords + valueWords> words;
+    };
+
+    static void packKey (const Key& key, Words& words) noexcept;
+    static size_t getSlotIndex (const Words& words) noexcept;
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<juce::uint64> hits { 0 }, misses { 0 }, evictions { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (CoefficientCache)
+};
+
+/** designChain() going through the shared cache one stage at a time, with
+    misses designed by FastDesign::designChain(). Lock-free, and only
+    allocates for a peak gain past FastDesign::maxPeakGainDecibels, which
+    FastDesign hands to the JUCE designer.
+*/
+ChainCoefficients designChainCached (const FilterSet& settings, double sampleRate);
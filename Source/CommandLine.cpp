@@ -0,0 +1,493 @@
+/*
+  ==============================================================================
+
+    CommandLine.cpp
+
+  ==============================================================================
+*/
+
+#include "CommandLine.h"
+#include "OfflineRenderer.h"
+#include "RawPcm.h"
+#include "GoldenReference.h"
+#include "SpectrumMatch.h"
+#include "FastDesign.h"
+#include "LiveAudio.h"
+#include "ChainResponse.h"
+#include "PluginProcessor.h"
+#include "Benchmarks.h"
+
+static Gradient parseSlope (const juce::String& text)
+{
+    return makeGradient (text.getIntValue());
+}
+
+FilterSet parseFilterSet (const juce::ArgumentList& args)
+{
+    // Same defaults as the plugin's parameters.
+    FilterSet settings;
+    settings.lowCutFreq = 20.f;
+    settings.highCutFreq = 20000.f;
+    settings.peakFreq = 750.f;
+    settings.peakGain = 0.f;
+    settings.peakQual = 1.f;
+
+    if (args.containsOption ("--low-cut"))        settings.lowCutFreq = args.getValueForOption ("--low-cut").getFloatValue();
+    if (args.containsOption ("--low-cut-slope"))  settings.lowCutSlope = parseSlope (args.getValueForOption ("--low-cut-slope"));
+    if (args.containsOption ("--high-cut"))       settings.highCutFreq = args.getValueForOption ("--high-cut").getFloatValue();
+    if (args.containsOption ("--high-cut-slope")) settings.highCutSlope = parseSlope (args.getValueForOption ("--high-cut-slope"));
+    if (args.containsOption ("--peak"))           settings.peakFreq = args.getValueForOption ("--peak").getFloatValue();
+    if (args.containsOption ("--peak-gain"))      settings.peakGain = args.getValueForOption ("--peak-gain").getFloatValue();
+    if (args.containsOption ("--peak-q"))         settings.peakQual = args.getValueForOption ("--peak-q").getFloatValue();
+
+    return settings;
+}
+
+/** The reverse of parseFilterSet(), so a result can be pasted into --render. */
+static juce::String formatFilterSet (const FilterSet& settings)
+{
+    return "--low-cut=" + juce::String (settings.lowCutFreq, 1)
+         + " --low-cut-slope=" + juce::String (getDecibelsPerOctave (settings.lowCutSlope))
+         + " --high-cut=" + juce::String (settings.highCutFreq, 1)
+         + " --high-cut-slope=" + juce::String (getDecibelsPerOctave (settings.highCutSlope))
+         + " --peak=" + juce::String (settings.peakFreq, 1)
+         + " --peak-gain=" + juce::String (settings.peakGain, 1)
+         + " --peak-q=" + juce::String (settings.peakQual, 2);
+}
+
+const char* const filterSetHelp =
+    "EQ options (defaults match the plugin):\n"
+    "  --low-cut=<Hz> --low-cut-slope=<6|12|18|...|96>\n"
+    "  --high-cut=<Hz> --high-cut-slope=<6|12|18|...|96>\n"
+    "  --peak=<Hz> --peak-gain=<dB> --peak-q=<Q>\n";
+
+/** The lines --loudness adds to a render's summary. */
+static juce::String formatLoudness (const OfflineRenderer::Report& report)
+{
+    const auto change = report.outputLoudness.integrated - report.inputLoudness.integrated;
+
+    return "Input:  " + report.inputLoudness.toString() + "\n"
+         + "Output: " + report.outputLoudness.toString() + "\n"
+         + "Integrated change: " + (std::isfinite (change) ? juce::String (change, 1) + " LU" : juce::String ("-"));
+}
+
+//==============================================================================
+static void renderCommand (const juce::ArgumentList& args)
+{
+    args.checkMinNumArguments (3);
+
+    const auto input = args[1].resolveAsExistingFile();
+    const auto output = args[2].resolveAsFile();
+
+    OfflineRenderer::Options options;
+    options.splitIntoSegments = args.containsOption ("--segments");
+    options.useMemoryMapping = ! args.containsOption ("--buffered-io");
+    options.deterministic = args.containsOption ("--deterministic");
+    options.useParallelForm = args.containsOption ("--parallel");
+    options.measureLoudness = args.containsOption ("--loudness");
+
+    if (args.containsOption ("--threads"))
+        options.numThreads = juce::jmax (1, args.getValueForOption ("--threads").getIntValue());
+
+    if (args.containsOption ("--segment-seconds"))
+        options.segmentSeconds = juce::jmax (0.1, args.getValueForOption ("--segment-seconds").getDoubleValue());
+
+    OfflineRenderer renderer (parseFilterSet (args));
+    OfflineRenderer::Report report;
+    const auto error = renderer.renderFile (input, output, options, report);
+
+    if (error.isNotEmpty())
+        juce::ConsoleApplication::fail (error);
+
+    std::cout << "Rendered " << output.getFullPathName() << " in " << report.renderSeconds << " s ("
+              << (double) report.bytesProcessed / (1024.0 * 1024.0 * juce::jmax (1.0e-9, report.renderSeconds)) << " MB/s, "
+              << (report.memoryMapped ? "memory-mapped" : "buffered") << " input)" << std::endl;
+
+    if (options.splitIntoSegments)
+        std::cout << "Segments: " << report.numSegments
+                  << ", pre-roll: " << report.preRollSamples << " samples"
+                  << ", error bound: " << juce::Decibels::toString (report.errorBound)
+                  << ", measured seam error: " << juce::Decibels::toString (report.measuredSeamError) << std::endl;
+
+    if (report.bottleneck.isNotEmpty())
+        std::cout << "Threads busy: decode " << juce::roundToInt (report.decodeUtilisation * 100.0)
+                  << "%, filter " << juce::roundToInt (report.filterUtilisation * 100.0)
+                  << "%, encode " << juce::roundToInt (report.encodeUtilisation * 100.0)
+                  << "% (" << report.bottleneck << "-bound)" << std::endl;
+
+    if (options.deterministic)
+        std::cout << "Output hash: " << report.outputHash << std::endl;
+    else if (options.useParallelForm)
+        std::cout << (report.parallelForm ? "Parallel form" : "Cascade (parallel form rejected)")
+                  << ", estimated error " << juce::String (report.parallelErrorDb, 1) << " dB" << std::endl;
+
+    if (options.measureLoudness)
+        std::cout << formatLoudness (report) << std::endl;
+}
+
+static void renderRawCommand (const juce::ArgumentList& args)
+{
+    RawPcm::Format format;
+
+    if (args.containsOption ("--format") && ! RawPcm::Format::parseEncoding (args.getValueForOption ("--format"), format.encoding))
+        juce::ConsoleApplication::fail ("--format should be s16, s24, s32 or f32");
+
+    if (args.containsOption ("--sample-rate"))
+        format.sampleRate = args.getValueForOption ("--sample-rate").getDoubleValue();
+
+    if (args.containsOption ("--channels"))
+        format.numChannels = args.getValueForOption ("--channels").getIntValue();
+
+    OfflineRenderer::Options options;
+    options.deterministic = args.containsOption ("--deterministic");
+    options.useParallelForm = args.containsOption ("--parallel");
+    options.zeroCopyOutput = args.containsOption ("--zero-copy");
+    options.measureLoudness = args.containsOption ("--loudness");
+
+    OfflineRenderer renderer (parseFilterSet (args));
+    OfflineRenderer::Report report;
+    const auto error = renderer.renderRaw (format, 0, 1, options, report);
+
+    if (error.isNotEmpty())
+        juce::ConsoleApplication::fail (error);
+
+    // stdout carries the audio, so the summary goes to stderr.
+    std::cerr << "Rendered " << report.bytesProcessed / format.getBytesPerFrame() << " frames in " << report.renderSeconds << " s ("
+              << (double) report.bytesProcessed / (1024.0 * 1024.0 * juce::jmax (1.0e-9, report.renderSeconds)) << " MB/s, "
+              << (report.zeroCopyOutput ? "vmsplice" : "copied") << " output)" << std::endl;
+
+    std::cerr << "Threads busy: read " << juce::roundToInt (report.decodeUtilisation * 100.0)
+              << "%, filter " << juce::roundToInt (report.filterUtilisation * 100.0)
+              << "%, write " << juce::roundToInt (report.encodeUtilisation * 100.0) << "%" << std::endl;
+
+    if (options.deterministic)
+        std::cerr << "Output hash: " << report.outputHash << std::endl;
+
+    if (options.measureLoudness)
+        std::cerr << formatLoudness (report) << std::endl;
+}
+
+static void writeGoldenCommand (const juce::ArgumentList& args)
+{
+    args.checkMinNumArguments (2);
+
+    const auto directory = args[1].resolveAsFile();
+    const auto error = GoldenReference::writeReferences (directory);
+
+    if (error.isNotEmpty())
+        juce::ConsoleApplication::fail (error);
+
+    std::cout << "Wrote reference renders to " << directory.getFullPathName() << std::endl;
+}
+
+static void verifyGoldenCommand (const juce::ArgumentList& args)
+{
+    args.checkMinNumArguments (2);
+
+    GoldenReference::Tolerance tolerance;
+
+    if (args.containsOption ("--max-ulps"))
+        tolerance.maxUlps = juce::jmax (0, args.getValueForOption ("--max-ulps").getIntValue());
+
+    const auto results = GoldenReference::verify (args[1].resolveAsExistingFolder(), tolerance);
+    int numFailed = 0;
+
+    for (auto& result : results)
+    {
+        if (! result.passed)
+            ++numFailed;
+
+        std::cout << (result.passed ? "PASS  " : "FAIL  ") << result.caseName;
+
+        if (result.error.isNotEmpty())
+            std::cout << ": " << result.error << std::endl;
+        else
+            std::cout << ": worst error " << juce::String (result.worstErrorDb, 1) << " dB, "
+                      << result.worstUlps << " ulps, " << result.numFailingSamples << " samples out of tolerance" << std::endl;
+    }
+
+    if (numFailed > 0)
+        juce::ConsoleApplication::fail (juce::String (numFailed) + " of " + juce::String (results.size()) + " cases failed");
+
+    std::cout << "All " << results.size() << " cases passed" << std::endl;
+}
+
+static void matchCommand (const juce::ArgumentList& args)
+{
+    args.checkMinNumArguments (3);
+
+    const auto source = args[1].resolveAsExistingFile();
+    juce::Array<juce::File> references;
+
+    for (int i = 2; i < args.size() && ! args[i].isOption(); ++i)
+        references.add (args[i].resolveAsExistingFile());
+
+    SpectrumMatch::Options options;
+
+    if (args.containsOption ("--fft-order"))
+        options.fftOrder = juce::jlimit (8, 16, args.getValueForOption ("--fft-order").getIntValue());
+
+    if (args.containsOption ("--threads"))
+        options.numThreads = juce::jmax (1, args.getValueForOption ("--threads").getIntValue());
+
+    const auto result = SpectrumMatch::match (source, references, options);
+
+    if (result.error.isNotEmpty())
+        juce::ConsoleApplication::fail (result.error);
+
+    std::cout << formatFilterSet (result.settings) << std::endl
+              << "Fit error: " << juce::String (result.rmsErrorDb, 2) << " dB RMS, analysed "
+              << result.audioSeconds << " s of audio in " << result.analysisSeconds << " s ("
+              << result.audioSeconds / juce::jmax (1.0e-9, result.analysisSeconds) << "x realtime)" << std::endl;
+}
+
+static void checkFastDesignCommand (const juce::ArgumentList& args)
+{
+    const auto numBands = args.containsOption ("--bands") ? juce::jmax (1, args.getValueForOption ("--bands").getIntValue()) : 64;
+    const auto report = FastDesign::runCheck (numBands);
+
+    const auto formatMicroseconds = [] (double seconds) { return juce::String (seconds * 1.0e6, 3) + " us"; };
+
+    std::cout << report.numChains << " chains, " << report.numProbes << " probes above -60 dB, "
+              << report.numResolvedProbes << " resolvable to " << FastDesign::CheckReport::errorBoundDb << " dB" << std::endl
+              << "Worst error: " << juce::String (report.maxErrorDb, 4) << " dB where resolvable, "
+              << juce::String (report.maxErrorUlps, 2) << " ulps anywhere" << std::endl
+              << "Chain: " << formatMicroseconds (report.exactChainSeconds) << " exact, " << formatMicroseconds (report.fastChainSeconds)
+              << " fast (" << juce::String (report.exactChainSeconds / report.fastChainSeconds, 1) << "x)" << std::endl
+              << "Peak, " << numBands << " at a time: " << formatMicroseconds (report.exactPeakSeconds) << " exact, "
+              << formatMicroseconds (report.fastPeakSeconds) << " fast ("
+              << juce::String (report.exactPeakSeconds / report.fastPeakSeconds, 1) << "x)" << std::endl;
+
+    if (! report.isWithinBounds())
+        juce::ConsoleApplication::fail ("The fast designer is out of bounds (" + juce::String (FastDesign::CheckReport::errorBoundDb)
+                                          + " dB, " + juce::String (FastDesign::CheckReport::errorBoundUlps) + " ulps)");
+}
+
+static void responseCommand (const juce::ArgumentList& args)
+{
+    const auto sampleRate = args.containsOption ("--sample-rate") ? juce::jmax (8000.0, args.getValueForOption ("--sample-rate").getDoubleValue()) : 48000.0;
+    const auto numPoints = args.containsOption ("--points") ? juce::jmax (1, args.getValueForOption ("--points").getIntValue()) : 1024;
+    const auto impulseLength = args.containsOption ("--impulse") ? juce::jmax (1, args.getValueForOption ("--impulse").getIntValue()) : 0;
+
+    // One set of EQ options per line, the same as --render takes them.
+    std::vector<FilterSet> settings;
+
+    if (args.containsOption ("--batch"))
+    {
+        juce::StringArray lines;
+        args.getExistingFileForOption ("--batch").readLines (lines);
+
+        for (auto& line : lines)
+            if (line.trim().isNotEmpty())
+                settings.push_back (parseFilterSet (juce::ArgumentList ("VonicForContribs", juce::StringArray::fromTokens (line, true))));
+    }
+    else
+    {
+        settings.push_back (parseFilterSet (args));
+    }
+
+    const auto frequencies = ChainResponse::makeLogFrequencies (numPoints, sampleRate);
+    std::vector<std::complex<double>> response ((size_t) numPoints);
+    std::vector<double> impulse ((size_t) impulseLength);
+
+    juce::MemoryOutputStream table;
+    table << (impulseLength > 0 ? "set,sample,value\n" : "set,frequency_hz,magnitude_db,phase_degrees,real,imag\n");
+
+    double evaluateSeconds = 0.0;
+
+    for (size_t set = 0; set < settings.size(); ++set)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto chain = designChain (settings[set], sampleRate);
+
+        if (impulseLength > 0)
+            ChainResponse::getImpulseResponse (chain, impulse.data(), impulseLength);
+        else
+            ChainResponse::getFrequencyResponse (chain, sampleRate, frequencies.data(), response.data(), numPoints);
+
+        evaluateSeconds += juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        for (int i = 0; i < impulseLength; ++i)
+            table << (int) set << "," << i << "," << juce::String (impulse[(size_t) i], 9) << "\n";
+
+        for (int i = 0; impulseLength == 0 && i < numPoints; ++i)
+        {
+            const auto& h = response[(size_t) i];
+            table << (int) set << "," << juce::String (frequencies[(size_t) i], 3)
+                  << "," << juce::String (juce::Decibels::gainToDecibels (std::abs (h), -400.0), 6)
+                  << "," << juce::String (juce::radiansToDegrees (std::arg (h)), 6)
+                  << "," << juce::String (h.real(), 9) << "," << juce::String (h.imag(), 9) << "\n";
+        }
+    }
+
+    if (args.containsOption ("--output"))
+    {
+        const auto file = args.getFileForOption ("--output");
+
+        if (! file.replaceWithData (table.getData(), table.getDataSize()))
+            juce::ConsoleApplication::fail ("Couldn't write " + file.getFullPathName());
+    }
+    else
+    {
+        std::cout.write (static_cast<const char*> (table.getData()), (std::streamsize) table.getDataSize());
+    }
+
+    // On stderr, so that stdout stays a clean table.
+    std::cerr << settings.size() << " settings evaluated in " << evaluateSeconds << " s ("
+              << juce::String ((double) settings.size() / juce::jmax (1.0e-9, evaluateSeconds), 0) << " per second)" << std::endl;
+}
+
+static void deterministicCostCommand (const juce::ArgumentList& args)
+{
+    const auto seconds = args.containsOption ("--seconds") ? juce::jmax (0.1, args.getValueForOption ("--seconds").getDoubleValue()) : 60.0;
+    constexpr double sampleRate = 48000.0;
+
+    juce::AudioBuffer<float> noise (2, (int) (seconds * sampleRate));
+    juce::Random random (0x566f6e6963);
+
+    for (int ch = 0; ch < noise.getNumChannels(); ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            noise.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    OfflineRenderer renderer (parseFilterSet (args));
+    OfflineRenderer::Options normal, deterministic;
+    deterministic.deterministic = true;
+
+    juce::AudioBuffer<float> normalOutput, firstOutput, secondOutput;
+    const auto normalReport = renderer.render (noise, normalOutput, sampleRate, normal);
+    const auto firstReport = renderer.render (noise, firstOutput, sampleRate, deterministic);
+    const auto secondReport = renderer.render (noise, secondOutput, sampleRate, deterministic);
+
+    float difference = 0.0f;
+
+    for (int ch = 0; ch < noise.getNumChannels(); ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            difference = juce::jmax (difference, std::abs (normalOutput.getSample (ch, i) - firstOutput.getSample (ch, i)));
+
+    const auto deterministicSeconds = juce::jmin (firstReport.renderSeconds, secondReport.renderSeconds);
+
+    std::cout << "Rendering " << seconds << " s of stereo noise at 48 kHz:" << std::endl
+              << "  normal: " << normalReport.renderSeconds << " s" << std::endl
+              << "  deterministic: " << deterministicSeconds << " s ("
+              << juce::String (deterministicSeconds / juce::jmax (1.0e-9, normalReport.renderSeconds), 2) << "x)" << std::endl
+              << "  largest difference between them: " << juce::Decibels::toString (juce::Decibels::gainToDecibels (difference)) << std::endl
+              << "  output hash: " << firstReport.outputHash << std::endl;
+
+    if (firstReport.outputHash != secondReport.outputHash)
+        juce::ConsoleApplication::fail ("Two deterministic renders of the same input differ ("
+                                          + firstReport.outputHash + ", " + secondReport.outputHash + ")");
+}
+
+//==============================================================================
+bool runCommandLine (const juce::StringArray& arguments, int& exitCode)
+{
+    juce::ArgumentList args ("VonicForContribs", arguments);
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "Usage: VonicForContribs <command> [options]\n\n" + LiveAudio::Options::getHelpText(), false);
+
+    app.addCommand ({ "--render",
+                      "--render <input> <output> [--segments] [--threads=<n>] [--segment-seconds=<s>] [--buffered-io] [--deterministic] [--parallel] [--loudness] [EQ options]",
+                      "Filters an audio file through the EQ without opening a window.",
+                      juce::String ("With --segments the file is cut into pieces that are rendered in parallel, each with enough "
+                                    "pre-roll for the filter tails to settle. The seam error is bounded up front and measured "
+                                    "afterwards; if it comes out too large the file is rendered serially instead.\n\n"
+                                    "WAV and AIFF input is memory-mapped; --buffered-io reads it through a normal stream "
+                                    "instead, which is useful for comparing the MB/s figure printed at the end.\n\n"
+                                    "--deterministic renders samples that are bit-identical on every machine and prints a hash "
+                                    "of them, for checking render farm output. It always renders serially.\n\n"
+                                    "--parallel runs the EQ as a sum of sections rather than a chain of them, where that can "
+                                    "be done accurately; see --bench-parallel.\n\n"
+                                    "--loudness also prints the BS.1770 loudness (momentary and short-term at the end, "
+                                    "integrated) and true peak of the input and the output, measured as the file is "
+                                    "rendered.\n\n")
+                        + filterSetHelp,
+                      renderCommand });
+
+    app.addCommand ({ "--render-raw",
+                      "--render-raw [--format=<s16|s24|s32|f32>] [--sample-rate=<Hz>] [--channels=<n>] [--zero-copy] [--deterministic] [--parallel] [--loudness] [EQ options]",
+                      "Filters raw interleaved PCM from stdin to stdout, for use in shell pipelines.",
+                      juce::String ("The input has no header, so its format comes from --format (default s16, always "
+                                    "little-endian), --sample-rate (default 48000) and --channels (default 2). The output "
+                                    "is in the same format. Reading, filtering and writing run on three threads, as with "
+                                    "--render, and a summary goes to stderr at the end, with the same --loudness "
+                                    "figures as --render.\n\n"
+                                    "On Linux, pipes on either side are grown to 1 MB. --zero-copy hands the output to the "
+                                    "pipe with vmsplice() instead of copying it; only use it when the next program reads "
+                                    "the pipe normally, since one that splices the data on (some builds of pv, for "
+                                    "instance) can see it overwritten.\n\n")
+                        + filterSetHelp,
+                      renderRawCommand });
+
+    app.addCommand ({ "--match",
+                      "--match <source> <reference> [more references...] [--fft-order=<n>] [--threads=<n>]",
+                      "Fits the EQ so that <source> takes on the tonal balance of the references.",
+                      "Long-term spectra of every file are measured in parallel, the references are averaged, and the "
+                      "low cut, peak and high cut are fitted to the difference in 1/6 octave bands. Level differences "
+                      "are ignored. The result is printed as EQ options for --render; in the plugin, the same match "
+                      "is available from the editor's Match button.",
+                      matchCommand });
+
+    app.addCommand ({ "--write-golden",
+                      "--write-golden <folder>",
+                      "Writes the reference renders used by --verify-golden.",
+                      "The cases are rendered through the plugin in deterministic mode. The references in Tests/Golden "
+                      "have to come from a build whose output is known to be right; rewriting them after a change that "
+                      "moves the output is a deliberate decision, not a fix for a failing check.",
+                      writeGoldenCommand });
+
+    app.addCommand ({ "--verify-golden",
+                      "--verify-golden <folder> [--max-ulps=<n>]",
+                      "Checks the plugin's output against the references in <folder>, normally Tests/Golden.",
+                      "Impulses, sweeps and noise are run through the plugin in deterministic mode, at every slope "
+                      "and at the edges of each parameter, at 44.1 and 96 kHz. Deterministic renders are the same on "
+                      "every machine, so every sample must match its reference exactly, or to within --max-ulps "
+                      "(default 0). The exit code is non-zero if any case fails.",
+                      verifyGoldenCommand });
+
+    app.addCommand ({ "--check-fast-design",
+                      "--check-fast-design [--bands=<n>]",
+                      "Compares the approximate filter designer with the exact one, and times both.",
+                      "Every slope and a grid of frequencies, Qs and gains is designed both ways at 44.1 to 192 kHz. "
+                      "Where one ULP on each coefficient moves the response by less than 0.01 dB, the responses must "
+                      "agree within 0.01 dB; elsewhere, within 8 of those ULP steps. Peak filters are timed in batches "
+                      "of --bands (default 64). The exit code is non-zero if either bound is exceeded.",
+                      checkFastDesignCommand });
+
+    app.addCommand ({ "--response",
+                      "--response [--points=<n>] [--sample-rate=<Hz>] [--impulse=<n>] [--batch=<file>] [--output=<file>] [EQ options]",
+                      "Prints the EQ's frequency or impulse response as CSV, worked out from its coefficients.",
+                      juce::String ("The complex frequency response is given at --points (default 1024) log-spaced frequencies "
+                                    "from 10 Hz to Nyquist at --sample-rate (default 48000), or with --impulse, the first <n> "
+                                    "samples of the impulse response instead. No audio is rendered.\n\n"
+                                    "--batch evaluates every line of <file>, each holding EQ options as --render takes them, and "
+                                    "numbers the rows by line. The table goes to --output or stdout; the time taken goes to stderr.\n\n")
+                        + filterSetHelp,
+                      responseCommand });
+
+    app.addCommand ({ "--deterministic-cost",
+                      "--deterministic-cost [--seconds=<s>] [EQ options]",
+                      "Times a deterministic render against a normal one.",
+                      juce::String ("Renders --seconds (default 60) of seeded noise both ways, and the deterministic way twice "
+                                    "to check that the two hashes match. The exit code is non-zero if they don't.\n\n")
+                        + filterSetHelp,
+                      deterministicCostCommand });
+
+   #if VONIC_BENCHMARKS
+    addBenchmarkCommands (app);
+   #endif
+
+    if (args.size() == 0)
+        return false;
+
+    for (auto& command : app.getCommands())
+    {
+        if (command.commandOption.isNotEmpty() && args[0] == command.commandOption)
+        {
+            exitCode = app.findAndRunCommand (args);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    CommandLine.h
+
+    Headless tools that live inside the standalone build, so render farms
+    and QC scripts can use the EQ without a host or a window.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+/** Runs the command named by the first argument, if it is one of ours.
+    Returns false (and leaves exitCode alone) when the standalone app should
+    just start normally.
+*/
+bool runCommandLine (const juce::StringArray& arguments, int& exitCode);
+
+/** Reads the EQ options every command takes, defaulting to the plugin's
+    parameter defaults.
+*/
+FilterSet parseFilterSet (const juce::ArgumentList& args);
+
+/** The help text for the options parseFilterSet() reads. */
+extern const char* const filterSetHelp;
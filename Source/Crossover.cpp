@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    Crossover.cpp
+
+  ==============================================================================
+*/
+
+#include "Crossover.h"
+
+CrossoverCoefficients designCrossover (const FilterSet& settings, double sampleRate, ChainDesigner design)
+{
+    // The cut stages only ever design the high pass at the low cut frequency
+    // and the low pass at the high cut frequency. Swapping the frequencies
+    // and slopes gets the other half from the same designer.
+    auto swapped = settings;
+    swapped.lowCutFreq = settings.highCutFreq;
+    swapped.lowCutSlope = settings.highCutSlope;
+    swapped.highCutFreq = settings.lowCutFreq;
+    swapped.highCutSlope = settings.lowCutSlope;
+
+    const auto chain = design (settings, sampleRate);
+    const auto other = design (swapped, sampleRate);
+
+    CrossoverCoefficients crossover;
+    crossover.peak = chain.peak;
+    crossover.lowSplitHighPass = chain.lowCut;
+    crossover.lowSplitLowPass = other.highCut;
+    crossover.numLowSplit = chain.numLowCut;
+    crossover.highSplitLowPass = chain.highCut;
+    crossover.highSplitHighPass = other.lowCut;
+    crossover.numHighSplit = chain.numHighCut;
+    crossover.lowSplitIsOdd = getCutOrder (settings.lowCutSlope) % 2 != 0;
+    crossover.highSplitIsOdd = getCutOrder (settings.highCutSlope) % 2 != 0;
+    return crossover;
+}
+
+//==============================================================================
+int Crossover::makeBand (BandSections& band, const Sections& sections, int numSections, bool invert) noexcept
+{
+    for (int i = 0; i < numSections; ++i)
+        band[(size_t) i] = band[(size_t) (i + numSections)] = sections[(size_t) i];
+
+    if (invert && numSections > 0)
+    {
+        auto& c = band[0];
+        c.b0 = -c.b0;
+        c.b1 = -c.b1;
+        c.b2 = -c.b2;
+    }
+
+    return 2 * numSections;
+}
+
+int Crossover::makeAllpass (Sections& allpass, const CrossoverCoefficients& coefficients) noexcept
+{
+    for (int i = 0; i < coefficients.numHighSplit; ++i)
+    {
+        const auto& c = coefficients.highSplitLowPass[(size_t) i];
+        allpass[(size_t) i] = (i == 0 && coefficients.highSplitIsOdd) ? SectionCoefficients { c.a1, 1.f, 0.f, c.a1, 0.f }
+                                                                      : SectionCoefficients { c.a2, c.a1, 1.f, c.a1, c.a2 };
+    }
+
+    return coefficients.numHighSplit;
+}
+
+void Crossover::setCoefficients (const CrossoverCoefficients& coefficients) noexcept
+{
+    peak.setSections (&coefficients.peak, 1);
+
+    BandSections band;
+    lowBand.setSections (band.data(), makeBand (band, coefficients.lowSplitLowPass, coefficients.numLowSplit));
+    lowSplitHighPass.setSections (band.data(), makeBand (band, coefficients.lowSplitHighPass, coefficients.numLowSplit,
+                                                         coefficients.lowSplitIsOdd));
+    midBand.setSections (band.data(), makeBand (band, coefficients.highSplitLowPass, coefficients.numHighSplit));
+    highBand.setSections (band.data(), makeBand (band, coefficients.highSplitHighPass, coefficients.numHighSplit,
+                                                 coefficients.highSplitIsOdd));
+
+    Sections allpass;
+    lowBandAllpass.setSections (allpass.data(), makeAllpass (allpass, coefficients));
+}
+
+void Crossover::reset() noexcept
+{
+    for (auto* cascade : { &peak, &lowBand, &lowBandAllpass, &lowSplitHighPass, &midBand, &highBand })
+        cascade->reset();
+}
+
+void Crossover::process (float* low, float* mid, float* high, int numSamples) noexcept
+{
+    peak.process (mid, numSamples);
+
+    juce::FloatVectorOperations::copy (low, mid, numSamples);
+    lowBand.process (low, numSamples);
+    lowBandAllpass.process (low, numSamples);
+
+    lowSplitHighPass.process (mid, numSamples);
+
+    juce::FloatVectorOperations::copy (high, mid, numSamples);
+    highBand.process (high, numSamples);
+    midBand.process (mid, numSamples);
+}
+
+juce::uint32 Crossover::getNumResets() const noexcept
+{
+    juce::uint32 numResets = 0;
+
+    for (auto* cascade : { &peak, &lowBand, &lowBandAllpass, &lowSplitHighPass, &midBand, &highBand })
+        numResets += cascade->getNumResets();
+
+    return numResets;
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    Crossover.h
+
+    The low-cut and high-cut stages run as a 3-way Linkwitz-Riley crossover
+    instead of throwing away what they cut. Each split reuses the cut
+    stage's Butterworth sections twice over, so a band's slope is double the
+    cut's (12 to 192 dB/oct), and the low and high pass at a split add up to
+    an allpass. At odd orders it is their difference that is allpass, so the
+    high side of those splits is inverted. The low band also goes through
+    the high split's allpass, so low + mid + high has a flat magnitude
+    response, with no latency.
+
+    The peak is applied before the split, so it shapes all three bands.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+#include "CoefficientCache.h"
+
+struct CrossoverCoefficients
+{
+    using Sections = std::array<SectionCoefficients, ChainCoefficients::maxCutSections>;
+
+    SectionCoefficients peak;
+
+    /** Butterworth sections of each split. The lower split is at the low
+        cut's frequency and slope, the upper one at the high cut's.
+    */
+    Sections lowSplitLowPass, lowSplitHighPass, highSplitLowPass, highSplitHighPass;
+    int numLowSplit = 0, numHighSplit = 0;
+
+    /** Odd Butterworth order, which starts with a first-order section. */
+    bool lowSplitIsOdd = false, highSplitIsOdd = false;
+};
+
+/** Designs the splits for these settings with a designChain() equivalent.
+    The default goes through the shared coefficient cache, which already
+    holds half of them if the plain EQ has run.
+*/
+using ChainDesigner = ChainCoefficients (*) (const FilterSet&, double);
+CrossoverCoefficients designCrossover (const FilterSet& settings, double sampleRate,
+                                       ChainDesigner design = designChainCached);
+
+//==============================================================================
+/** One channel of the crossover.
+
+    Each filter a band goes through is a Cascade, so its sections run in
+    one fused pass over the block rather than one pass each: six passes in
+    all (the peak, the two halves of each split and the low band's allpass)
+    instead of up to 73 at 96 dB/oct.
+*/
+class Crossover
+{
+public:
+    void setCoefficients (const CrossoverCoefficients& coefficients) noexcept;
+    void reset() noexcept;
+
+    /** Splits mid in place into low, mid and high. The three buffers must
+        not overlap.
+    */
+    void process (float* low, float* mid, float* high, int numSamples) noexcept;
+
+    /** Sum of every cascade's getNumResets(). */
+    juce::uint32 getNumResets() const noexcept;
+
+    using Sections = CrossoverCoefficients::Sections;
+    using BandSections = std::array<SectionCoefficients, 2 * ChainCoefficients::maxCutSections>;
+
+    /** A split's squared Butterworth, every section twice, inverted if asked.
+        Returns the number of sections.
+    */
+    static int makeBand (BandSections& band, const Sections& sections, int numSections, bool invert = false) noexcept;
+
+    /** LP^2 + HP^2 (or LP^2 - HP^2) at the upper split is the allpass with
+        the same poles, one section per Butterworth section (the low and high
+        pass share them). A first-order section's allpass is first order too.
+    */
+    static int makeAllpass (Sections& allpass, const CrossoverCoefficients& coefficients) noexcept;
+
+private:
+    Cascade peak, lowBand, lowBandAllpass, lowSplitHighPass, midBand, highBand;
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Determinism.cpp
+
+  ==============================================================================
+*/
+
+#include "Determinism.h"
+#include "FastDesign.h"
+
+namespace Determinism
+{
+
+static constexpr juce::uint64 fnvOffset = 0xcbf29ce484222325ull, fnvPrime = 0x100000001b3ull;
+
+ChainCoefficients designChain (const FilterSet& settings, double sampleRate)
+{
+    return FastDesign::designChain (settings, sampleRate);
+}
+
+void flushDenormals (float* samples, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] = std::abs (samples[i]) < std::numeric_limits<float>::min() ? 0.0f : samples[i];
+}
+
+//==============================================================================
+void AudioHash::add (const float* const* channels, int numChannels, int numSamples)
+{
+    if ((int) channelHashes.size() < numChannels)
+        channelHashes.resize ((size_t) numChannels, fnvOffset);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto hash = channelHashes[(size_t) ch];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            juce::uint32 bits;
+            std::memcpy (&bits, channels[ch] + i, sizeof (bits));
+
+            for (int byte = 0; byte < 4; ++byte)
+                hash = (hash ^ ((bits >> (8 * byte)) & 0xff)) * fnvPrime;
+        }
+
+        channelHashes[(size_t) ch] = hash;
+    }
+}
+
+juce::uint64 AudioHash::get() const noexcept
+{
+    auto hash = fnvOffset;
+
+    for (auto channelHash : channelHashes)
+        for (int byte = 0; byte < 8; ++byte)
+            hash = (hash ^ ((channelHash >> (8 * byte)) & 0xff)) * fnvPrime;
+
+    return hash;
+}
+
+juce::String AudioHash::toString() const
+{
+    return juce::String::toHexString ((juce::int64) get()).paddedLeft ('0', 16);
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    Determinism.h
+
+    Pieces of the deterministic mode, in which the processor and the offline
+    renderer produce bit-identical output on any machine:
+
+    - coefficients come from FastDesign, which only adds, multiplies and
+      divides, rather than from libm's sin/cos/tan, whose last bit differs
+      between libraries and ISAs;
+    - only the scalar biquad runs, one channel at a time from the start of
+      the material (no segments, no SIMD batch);
+    - denormals are flushed in software on the way in and out, on top of
+      FTZ/DAZ, so whatever the host or CPU does with them can't matter.
+
+    The build turns off FMA contraction (-ffp-contract=off) for everything,
+    since contraction is decided at compile time, not at run time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+namespace Determinism
+{
+    /** The deterministic mode's designChain(). */
+    ChainCoefficients designChain (const FilterSet& settings, double sampleRate);
+
+    /** Replaces anything below FLT_MIN in magnitude with zero. */
+    void flushDenormals (float* samples, int numSamples) noexcept;
+
+    /** 64-bit FNV-1a over the bits of each channel in turn, fed in blocks of
+        any size; two renders hash the same only if every sample matches.
+    */
+    class AudioHash
+    {
+    public:
+        void add (const float* const* channels, int numChannels, int numSamples);
+        void add (const juce::AudioBuffer<float>& buffer)   { add (buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples()); }
+
+        juce::uint64 get() const noexcept;
+        juce::String toString() const;
+
+    private:
+        std::vector<juce::uint64> channelHashes;
+    };
+}
@@ -0,0 +1,375 @@
+/*
+  ==============================================================================
+
+    FastDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "FastDesign.h"
+
+namespace FastDesign
+{
+
+static constexpr auto width = Register::size();
+
+template <typename T>
+struct SectionLanes
+{
+    T b0, b1, b2, a1, a2;
+};
+
+// makePeakFilter with omega = 2 theta, and A and 1 / A as exp (+/- exponent).
+template <typename T>
+static SectionLanes<T> designPeakLanes (T theta, T invQ, T exponent) noexcept
+{
+    const auto s = sinApprox (theta), c = cosApprox (theta);
+    const auto alpha = s * c * invQ;
+    const auto alphaTimesA = alpha * expApprox (exponent);
+    const auto alphaOverA = alpha * expApprox (exponent * -1.0f);
+    const auto norm = reciprocal (alphaOverA + 1.0f);
+    const auto b1 = (s * s * -2.0f + 1.0f) * norm * -2.0f;
+
+    return { (alphaTimesA + 1.0f) * norm, b1, (alphaTimesA * -1.0f + 1.0f) * norm,
+             b1, (alphaOverA * -1.0f + 1.0f) * norm };
+}
+
+// makeLowPass and makeHighPass with tan (theta) = s / c, multiplied through
+// by c * c or s * s. highpass is 1 for a high pass lane, 0 for a low pass.
+template <typename T>
+static SectionLanes<T> designCutLanes (T theta, T invQ, T highpass) noexcept
+{
+    const auto s = sinApprox (theta), c = cosApprox (theta);
+    const auto s2 = s * s, c2 = c * c;
+    const auto damping = s * c * invQ;
+    const auto norm = reciprocal (damping + 1.0f);
+    const auto b0 = (s2 + (c2 - s2) * highpass) * norm;
+
+    return { b0, b0 * (highpass * -4.0f + 2.0f), b0,
+             (s2 - c2) * norm * 2.0f, (damping * -1.0f + 1.0f) * norm };
+}
+
+// makeFirstOrderLowPass and makeFirstOrderHighPass, the same way round.
+static SectionCoefficients designFirstOrderCut (float theta, bool highpass) noexcept
+{
+    const auto s = sinApprox (theta), c = cosApprox (theta);
+    const auto norm = reciprocal (s + c);
+    const auto b0 = (highpass ? c : s) * norm;
+
+    return { b0, highpass ? -b0 : b0, 0.0f, (s - c) * norm, 0.0f };
+}
+
+// 1 / Q of each second-order section of a Butterworth of every order, in the
+// order FilterDesign returns them: 2 cos ((2i + 1) pi / 2n) for even n, and
+// for odd n, 2 cos ((i + 1) pi / n) after the first-order section. Written
+// out rather than computed, so nothing here depends on the platform's libm.
+static constexpr float butterworthInvQ[numGradients][ChainCoefficients::maxCutSections] =
+{
+    {},
+    { 1.41421354f },
+    { 1.0f },
+    { 1.84775901f, 0.765366852f },
+    { 1.61803401f, 0.618034005f },
+    { 1.93185163f, 1.41421354f, 0.517638087f },
+    { 1.80193770f, 1.24697959f, 0.445041865f },
+    { 1.96157050f, 1.66293919f, 1.11114049f, 0.390180647f },
+    { 1.87938523f, 1.53208888f, 1.0f, 0.347296357f },
+    { 1.97537673f, 1.78201306f, 1.41421354f, 0.907980978f, 0.312868923f },
+    { 1.91898596f, 1.68250704f, 1.30972147f, 0.830830038f, 0.284629673f },
+    { 1.98288977f, 1.84775901f, 1.58670664f, 1.21752286f, 0.765366852f, 0.261052370f },
+    { 1.94188368f, 1.77091205f, 1.49702156f, 1.13612950f, 0.709209800f, 0.241073355f },
+    { 1.98742437f, 1.88776672f, 1.69344842f, 1.41421354f, 1.06406415f, 0.660558105f, 0.223928958f },
+    { 1.95629525f, 1.82709086f, 1.61803401f, 1.33826125f, 1.0f, 0.618034005f, 0.209056929f },
+    { 1.99036944f, 1.91388071f, 1.76384258f, 1.54602087f, 1.26878655f, 0.942793489f, 0.580569327f, 0.196034282f }
+};
+
+/** Half the angular frequency, theta = pi f / fs, for one sample rate. */
+struct HalfAngle
+{
+    explicit HalfAngle (double sampleRate) noexcept
+        : radiansPerHz ((float) (juce::MathConstants<double>::pi / sampleRate)),
+          highestFrequency ((float) (sampleRate * 0.49))
+    {}
+
+    // As in ChainDesign: the parameters reach past Nyquist at low rates, and
+    // makePeakFilter won't go below 2 Hz.
+    float operator() (float frequency) const noexcept   { return radiansPerHz * juce::jlimit (2.0f, highestFrequency, frequency); }
+
+    float radiansPerHz, highestFrequency;
+};
+
+static float getPeakExponent (float gainDecibels) noexcept
+{
+    // sqrt (10 ^ (dB / 20)) = exp (dB * ln (10) / 40)
+    return gainDecibels * 0.05756462732f;
+}
+
+//==============================================================================
+void designPeaks (const PeakBand* bands, SectionCoefficients* sections, int numBands, double sampleRate) noexcept
+{
+    const HalfAngle getTheta (sampleRate);
+
+    alignas (sizeof (Register)) float theta[width], invQ[width], exponent[width];
+    alignas (sizeof (Register)) float b0[width], b1[width], b2[width], a1[width], a2[width];
+
+    for (int start = 0; start < numBands; start += (int) width)
+    {
+        const auto count = juce::jmin ((int) width, numBands - start);
+
+        for (size_t i = 0; i < width; ++i)
+        {
+            // The tail is padded with a flat band, and thrown away.
+            const auto& band = (int) i < count ? bands[start + (int) i] : PeakBand();
+            jassert (std::abs (band.gainDecibels) <= maxPeakGainDecibels);
+
+            theta[i] = getTheta (band.frequency);
+            invQ[i] = 1.0f / band.quality;
+            exponent[i] = getPeakExponent (band.gainDecibels);
+        }
+
+        const auto lanes = designPeakLanes (Register::fromRawArray (theta), Register::fromRawArray (invQ), Register::fromRawArray (exponent));
+        lanes.b0.copyToRawArray (b0);
+        lanes.b1.copyToRawArray (b1);
+        lanes.b2.copyToRawArray (b2);
+        lanes.a1.copyToRawArray (a1);
+        lanes.a2.copyToRawArray (a2);
+
+        for (int i = 0; i < count; ++i)
+            sections[start + i] = { b0[i], b1[i], b2[i], a1[i], a2[i] };
+    }
+}
+
+void designCuts (float lowCutFrequency, Gradient lowCutSlope, float highCutFrequency, Gradient highCutSlope, double sampleRate,
+                 ChainCoefficients& chain) noexcept
+{
+    const HalfAngle getTheta (sampleRate);
+    static constexpr int maxLanes = (2 * ChainCoefficients::maxCutSections + (int) width - 1) / (int) width * (int) width;
+
+    alignas (sizeof (Register)) float theta[maxLanes], invQ[maxLanes], highpass[maxLanes];
+    alignas (sizeof (Register)) float b0[maxLanes], b1[maxLanes], b2[maxLanes], a1[maxLanes], a2[maxLanes];
+
+    chain.numLowCut = getNumCutSections (lowCutSlope);
+    chain.numHighCut = getNumCutSections (highCutSlope);
+
+    // A first-order section, if there is one, comes first in its stage and
+    // is designed on its own; only the second-order ones go into lanes.
+    const auto lowFirstOrder = getCutOrder (lowCutSlope) % 2, highFirstOrder = getCutOrder (highCutSlope) % 2;
+
+    if (lowFirstOrder != 0)
+        chain.lowCut[0] = designFirstOrderCut (getTheta (lowCutFrequency), true);
+
+    if (highFirstOrder != 0)
+        chain.highCut[0] = designFirstOrderCut (getTheta (highCutFrequency), false);
+
+    const auto numLowLanes = chain.numLowCut - lowFirstOrder;
+    const auto numSections = numLowLanes + chain.numHighCut - highFirstOrder;
+    int lane = 0;
+
+    for (int i = 0; i < numLowLanes; ++i, ++lane)
+    {
+        theta[lane] = getTheta (lowCutFrequency);
+        invQ[lane] = butterworthInvQ[getCutOrder (lowCutSlope) - 1][i];
+        highpass[lane] = 1.0f;
+    }
+
+    for (; lane < numSections; ++lane)
+    {
+        theta[lane] = getTheta (highCutFrequency);
+        invQ[lane] = butterworthInvQ[getCutOrder (highCutSlope) - 1][lane - numLowLanes];
+        highpass[lane] = 0.0f;
+    }
+
+    for (; lane % (int) width != 0; ++lane)
+    {
+        theta[lane] = 0.1f;
+        invQ[lane] = 1.0f;
+        highpass[lane] = 0.0f;
+    }
+
+    for (int start = 0; start < numSections; start += (int) width)
+    {
+        const auto lanes = designCutLanes (Register::fromRawArray (theta + start), Register::fromRawArray (invQ + start),
+                                           Register::fromRawArray (highpass + start));
+        lanes.b0.copyToRawArray (b0 + start);
+        lanes.b1.copyToRawArray (b1 + start);
+        lanes.b2.copyToRawArray (b2 + start);
+        lanes.a1.copyToRawArray (a1 + start);
+        lanes.a2.copyToRawArray (a2 + start);
+    }
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto& section = i < numLowLanes ? chain.lowCut[(size_t) (lowFirstOrder + i)]
+                                        : chain.highCut[(size_t) (highFirstOrder + i - numLowLanes)];
+        section = { b0[i], b1[i], b2[i], a1[i], a2[i] };
+    }
+}
+
+ChainCoefficients designChain (const FilterSet& settings, double sampleRate)
+{
+    ChainCoefficients chain;
+
+    if (std::abs (settings.peakGain) <= maxPeakGainDecibels)
+    {
+        const auto peak = designPeakLanes (HalfAngle (sampleRate) (settings.peakFreq), 1.0f / settings.peakQual,
+                                           getPeakExponent (settings.peakGain));
+        chain.peak = { peak.b0, peak.b1, peak.b2, peak.a1, peak.a2 };
+    }
+    else
+    {
+        chain.peak = designPeak (settings.peakFreq, settings.peakQual, settings.peakGain, sampleRate);
+    }
+
+    designCuts (settings.lowCutFreq, settings.lowCutSlope, settings.highCutFreq, settings.highCutSlope, sampleRate, chain);
+    return chain;
+}
+
+//==============================================================================
+template <typename Function>
+static double getSecondsPerCall (int numCalls, Function&& function)
+{
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numCalls; ++i)
+        function();
+
+    return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) / numCalls;
+}
+
+static double getSectionDb (const SectionCoefficients& c, std::complex<double> z1) noexcept
+{
+    const auto z2 = z1 * z1;
+    const auto numerator = (double) c.b0 + (double) c.b1 * z1 + (double) c.b2 * z2;
+    const auto denominator = 1.0 + (double) c.a1 * z1 + (double) c.a2 * z2;
+    return 10.0 * std::log10 (juce::jmax (std::norm (numerator) / std::norm (denominator), 1.0e-40));
+}
+
+/** How far the chain's response at z1 moves, in dB, if every coefficient is
+    one ULP out. Each section's dB adds up, so they're nudged one at a time.
+*/
+static double getUlpSensitivityDb (const ChainCoefficients& chain, std::complex<double> z1) noexcept
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+    double sensitivity = 0.0;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto section = sections[(size_t) i];
+        const auto base = getSectionDb (section, z1);
+
+        for (auto* coefficient : { &section.b0, &section.b1, &section.b2, &section.a1, &section.a2 })
+        {
+            const auto original = *coefficient;
+            *coefficient = std::nextafter (original, std::numeric_limits<float>::infinity());
+            sensitivity += std::abs (getSectionDb (section, z1) - base);
+            *coefficient = original;
+        }
+    }
+
+    return sensitivity;
+}
+
+CheckReport runCheck (int numBands)
+{
+    CheckReport report;
+
+    static constexpr double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+    static constexpr float qualities[] = { 0.1f, 0.7f, 2.0f, 10.0f };
+    static constexpr float gains[] = { -24.0f, -6.0f, -0.5f, 0.0f, 3.0f, 12.0f, 24.0f };
+    static constexpr int numFrequencies = 12, numProbes = 64;
+
+    const auto getGridFrequency = [] (int i) { return (float) (20.0 * std::pow (1000.0, i / (numFrequencies - 1.0))); };
+
+    std::vector<FilterSet> grid;
+
+    for (int f = 0; f < numFrequencies; ++f)
+        for (auto quality : qualities)
+            for (auto gain : gains)
+                for (int slope = 0; slope < numGradients; ++slope)
+                {
+                    FilterSet settings;
+                    settings.peakFreq = getGridFrequency (f);
+                    settings.peakQual = quality;
+                    settings.peakGain = gain;
+                    settings.lowCutFreq = getGridFrequency (f / 2);
+                    settings.lowCutSlope = static_cast<Gradient> (slope);
+                    settings.highCutFreq = getGridFrequency (numFrequencies - 1 - f / 3);
+                    settings.highCutSlope = static_cast<Gradient> (numGradients - 1 - slope);
+                    grid.push_back (settings);
+                }
+
+    for (auto sampleRate : sampleRates)
+    {
+        for (auto& settings : grid)
+        {
+            const auto exact = ::designChain (settings, sampleRate);
+            const auto fast = FastDesign::designChain (settings, sampleRate);
+            ++report.numChains;
+
+            for (int i = 0; i < numProbes; ++i)
+            {
+                const auto frequency = 10.0 * std::pow (sampleRate * 0.499 / 10.0, i / (numProbes - 1.0));
+                const auto exactDb = getResponseDb (exact, frequency, sampleRate);
+
+                if (exactDb < -60.0)
+                    continue;
+
+                const auto error = std::abs (getResponseDb (fast, frequency, sampleRate) - exactDb);
+                const auto sensitivity = getUlpSensitivityDb (exact, std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate));
+                ++report.numProbes;
+
+                if (sensitivity <= CheckReport::errorBoundDb)
+                {
+                    ++report.numResolvedProbes;
+                    report.maxErrorDb = juce::jmax (report.maxErrorDb, error);
+                }
+
+                report.maxErrorUlps = juce::jmax (report.maxErrorUlps, error / juce::jmax (sensitivity, 1.0e-9));
+            }
+        }
+    }
+
+    // Keeps the optimiser from dropping the designs being timed.
+    volatile float sink = 0.0f;
+
+    const auto timeChains = [&] (auto&& design)
+    {
+        return getSecondsPerCall (20, [&]
+        {
+            for (auto& settings : grid)
+                sink = sink + design (settings, 48000.0).peak.b0;
+        }) / (double) grid.size();
+    };
+
+    report.exactChainSeconds = timeChains ([] (const FilterSet& s, double sr) { return ::designChain (s, sr); });
+    report.fastChainSeconds = timeChains ([] (const FilterSet& s, double sr) { return FastDesign::designChain (s, sr); });
+
+    numBands = juce::jmax (1, numBands);
+    std::vector<PeakBand> bands ((size_t) numBands);
+    std::vector<SectionCoefficients> sections ((size_t) numBands);
+    juce::Random random (35);
+
+    for (auto& band : bands)
+        band = { 20.0f * std::pow (1000.0f, random.nextFloat()), 0.1f + 9.9f * random.nextFloat(), 48.0f * random.nextFloat() - 24.0f };
+
+    const auto numCalls = juce::jmax (1, 100000 / numBands);
+
+    report.exactPeakSeconds = getSecondsPerCall (numCalls, [&]
+    {
+        for (int i = 0; i < numBands; ++i)
+            sections[(size_t) i] = designPeak (bands[(size_t) i].frequency, bands[(size_t) i].quality, bands[(size_t) i].gainDecibels, 48000.0);
+
+        sink = sink + sections[0].b0;
+    }) / numBands;
+
+    report.fastPeakSeconds = getSecondsPerCall (numCalls, [&]
+    {
+        designPeaks (bands.data(), sections.data(), numBands, 48000.0);
+        sink = sink + sections[0].b0;
+    }) / numBands;
+
+    return report;
+}
+
+}
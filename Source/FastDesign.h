@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    FastDesign.h
+
+    Coefficient design without the libm calls. makePeakFilter and the
+    Butterworth designers spend most of their time in tan, sin, cos and pow;
+    here those are replaced by short polynomials that run on a SIMDRegister,
+    so that a whole batch of bands is designed in one pass.
+
+    Every formula is rewritten in terms of the sine and cosine of half the
+    angle, which keeps the polynomials inside [0, pi/2] where they are
+    accurate, and gets rid of tan altogether. The results match
+    ::designChain() to within float rounding of the coefficients; run
+    --check-fast-design for the measured response error and speed-up.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+namespace FastDesign
+{
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    //==============================================================================
+    // Each works on a float or a Register. The bounds are for the polynomial
+    // alone; float rounding adds a few ULPs on top.
+
+    /** sin(x) for |x| <= pi/2, absolute error below 6e-8. */
+    template <typename T>
+    T sinApprox (T x) noexcept
+    {
+        const auto x2 = x * x;
+        auto p = x2 * -2.5052108e-8f + 2.7557319e-6f;
+        p = p * x2 - 1.9841270e-4f;
+        p = p * x2 + 8.3333333e-3f;
+        p = p * x2 - 1.6666667e-1f;
+        p = p * x2 + 1.0f;
+        return x * p;
+    }
+
+    /** cos(x) for |x| <= pi/2, absolute error below 1e-8. */
+    template <typename T>
+    T cosApprox (T x) noexcept
+    {
+        const auto x2 = x * x;
+        auto p = x2 * 2.0876757e-9f - 2.7557319e-7f;
+        p = p * x2 + 2.4801587e-5f;
+        p = p * x2 - 1.3888889e-3f;
+        p = p * x2 + 4.1666667e-2f;
+        p = p * x2 - 0.5f;
+        return p * x2 + 1.0f;
+    }
+
+    /** exp(x) for |x| <= 1.5, relative error below 2e-8. Taylor series on
+        x / 8, then squared three times.
+    */
+    template <typename T>
+    T expApprox (T x) noexcept
+    {
+        const auto y = x * 0.125f;
+        auto p = y * 1.3888889e-3f + 8.3333333e-3f;
+        p = p * y + 4.1666667e-2f;
+        p = p * y + 1.6666667e-1f;
+        p = p * y + 0.5f;
+        p = p * y + 1.0f;
+        p = p * y + 1.0f;
+        p = p * p;
+        p = p * p;
+        return p * p;
+    }
+
+    inline float reciprocal (float x) noexcept      { return 1.0f / x; }
+
+    /** SIMDRegister has no divide, so this goes lane by lane; the loop is
+        simple enough for the compiler to turn back into a vector divide.
+    */
+    inline Register reciprocal (Register x) noexcept
+    {
+        alignas (sizeof (Register)) float lanes[Register::size()];
+        x.copyToRawArray (lanes);
+
+        for (auto& lane : lanes)
+            lane = 1.0f / lane;
+
+        return Register::fromRawArray (lanes);
+    }
+
+    //==============================================================================
+    /** The largest peak gain, in dB either way, that expApprox() can cover. */
+    static constexpr float maxPeakGainDecibels = 26.0f;
+
+    struct PeakBand
+    {
+        float frequency = 1000.f, quality = 1.f, gainDecibels = 0.f;
+    };
+
+    /** Same filters as IIR::Coefficients::makePeakFilter, for numBands bands
+        at once. Gains must be within +/- maxPeakGainDecibels.
+    */
+    void designPeaks (const PeakBand* bands, SectionCoefficients* sections, int numBands, double sampleRate) noexcept;
+
+    /** Same sections as the high order Butterworth designers, for every
+        section of both cut stages in one pass.
+    */
+    void designCuts (float lowCutFrequency, Gradient lowCutSlope, float highCutFrequency, Gradient highCutSlope, double sampleRate,
+                     ChainCoefficients& chain) noexcept;
+
+    /** Drop-in for ::designChain(). Falls back to it for peak gains outside
+        +/- maxPeakGainDecibels. Doesn't allocate.
+    */
+    ChainCoefficients designChain (const FilterSet& settings, double sampleRate);
+
+    //==============================================================================
+    /** What runCheck() measures, against ::designChain(), at every probe
+        frequency where that chain's response is above -60 dB.
+
+        Float coefficients can't pin down the response everywhere: a steep
+        20 Hz cut at 192 kHz moves by a fraction of a dB when one coefficient
+        changes by one ULP, and the exact designer is no closer to the true
+        filter there than this one. So the error is measured in dB where that
+        one-ULP sensitivity is below the dB bound, and in multiples of the
+        sensitivity everywhere.
+    */
+    struct CheckReport
+    {
+        int numChains = 0, numProbes = 0, numResolvedProbes = 0;
+
+        double maxErrorDb = 0.0, maxErrorUlps = 0.0;
+
+        /** Seconds per chain and per peak band, exact and fast. */
+        double exactChainSeconds = 0.0, fastChainSeconds = 0.0;
+        double exactPeakSeconds = 0.0, fastPeakSeconds = 0.0;
+
+        bool isWithinBounds() const noexcept    { return maxErrorDb <= errorBoundDb && maxErrorUlps <= errorBoundUlps; }
+
+        static constexpr double errorBoundDb = 0.01, errorBoundUlps = 8.0;
+    };
+
+    /** Runs both designers over a grid of settings and sample rates, and
+        times them against each other, the peaks on batches of numBands.
+    */
+    CheckReport runCheck (int numBands);
+}
@@ -0,0 +1,343 @@
+/*
+  ==============================================================================
+
+    GoldenReference.cpp
+
+  ==============================================================================
+*/
+
+#include "GoldenReference.h"
+#include "PluginProcessor.h"
+
+namespace GoldenReference
+{
+
+//==============================================================================
+// Parameter values are in plugin units; slopes are Gradient indices. They are
+// snapped to the parameters' own steps before either render sees them.
+struct ParameterCase
+{
+    const char* name;
+    float lowCut;  int lowCutSlope;
+    float highCut; int highCutSlope;
+    float peak, peakGain, peakQ;
+};
+
+static const ParameterCase parameterCases[] =
+{
+    { "flat",              20.f,    grad12, 20000.f, grad12, 750.f,   0.f,  1.f  },
+    { "slope6",            100.f,   grad6,  8000.f,  grad6,  1000.f,  6.f,  1.f  },
+    { "slope12",           100.f,   grad12, 8000.f,  grad12, 1000.f,  6.f,  1.f  },
+    { "slope18",           100.f,   grad18, 8000.f,  grad18, 1000.f,  6.f,  1.f  },
+    { "slope24",           100.f,   grad24, 8000.f,  grad24, 1000.f,  6.f,  1.f  },
+    { "slope36",           100.f,   grad36, 8000.f,  grad36, 1000.f,  6.f,  1.f  },
+    { "slope48",           100.f,   grad48, 8000.f,  grad48, 1000.f,  6.f,  1.f  },
+    { "slope96",           100.f,   grad96, 8000.f,  grad96, 1000.f,  6.f,  1.f  },
+    { "low-cut-top",       20000.f, grad48, 20000.f, grad48, 750.f,   0.f,  1.f  },
+    { "high-cut-bottom",   20.f,    grad48, 20.f,    grad48, 750.f,   0.f,  1.f  },
+    { "peak-bottom-boost", 20.f,    grad12, 20000.f, grad12, 20.f,    24.f, 10.f },
+    { "peak-top-cut",      20.f,    grad12, 20000.f, grad12, 20000.f, -24.f, 10.f },
+    { "peak-wide-boost",   20.f,    grad12, 20000.f, grad12, 1000.f,  24.f, 0.1f },
+};
+
+static const double sampleRates[] = { 44100.0, 96000.0 };
+
+enum class Signal { impulse, sweep, noise };
+static const Signal signals[] = { Signal::impulse, Signal::sweep, Signal::noise };
+
+static constexpr int signalLength = 8192;
+
+// Deliberately not a power of two, so block edges land all over the place.
+static constexpr int blockSize = 480;
+
+static const char* getSignalName (Signal signal)
+{
+    switch (signal)
+    {
+        case Signal::impulse: return "impulse";
+        case Signal::sweep:   return "sweep";
+        case Signal::noise:   return "noise";
+    }
+
+    return "";
+}
+
+// The signals are made with only +, -, *, / and sqrt, which IEEE rounds the
+// same way everywhere, so they are as reproducible as the renders; libm's
+// sin and exp, and juce::Random, could each change between platforms or
+// versions.
+static double sinWithoutLibm (double x)
+{
+    constexpr auto twoPi = juce::MathConstants<double>::twoPi;
+    x -= twoPi * std::floor (x / twoPi + 0.5);
+
+    auto term = x, sum = x;
+
+    for (int k = 1; k < 16; ++k)
+    {
+        term *= -x * x / (double) ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+static std::vector<float> makeSignal (Signal signal, double sampleRate)
+{
+    std::vector<float> samples ((size_t) signalLength, 0.f);
+
+    if (signal == Signal::impulse)
+    {
+        samples[0] = 1.f;
+    }
+    else if (signal == Signal::sweep)
+    {
+        // Exponential sweep from 20 Hz up to just short of Nyquist: the
+        // frequency grows by the signalLength-th root of the span each
+        // sample, taken as repeated square roots.
+        static_assert (juce::isPowerOfTwo (signalLength), "the sweep's growth is taken by halving");
+        const auto start = 20.0, end = sampleRate * 0.45;
+        auto growth = end / start;
+
+        for (int n = signalLength; n > 1; n /= 2)
+            growth = std::sqrt (growth);
+
+        auto increment = juce::MathConstants<double>::twoPi * start / sampleRate;
+        auto phase = 0.0;
+
+        for (auto& sample : samples)
+        {
+            sample = (float) (0.5 * sinWithoutLibm (phase));
+            phase += increment;
+            increment *= growth;
+        }
+    }
+    else
+    {
+        // xorshift32, scaled exactly to floats in [-0.5, 0.5).
+        juce::uint32 state = 0x5eed;
+
+        for (auto& sample : samples)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            sample = 0.5f * ((float) (state >> 8) * (2.0f / 16777216.0f) - 1.0f);
+        }
+    }
+
+    return samples;
+}
+
+//==============================================================================
+static void applyParameters (VonicRewriteAudioProcessor& processor, const ParameterCase& parameters)
+{
+    FilterSet settings;
+    settings.lowCutFreq = parameters.lowCut;
+    settings.lowCutSlope = (Gradient) parameters.lowCutSlope;
+    settings.highCutFreq = parameters.highCut;
+    settings.highCutSlope = (Gradient) parameters.highCutSlope;
+    settings.peakFreq = parameters.peak;
+    settings.peakGain = parameters.peakGain;
+    settings.peakQual = parameters.peakQ;
+    setFilterSet (processor.bleh, settings);
+}
+
+static std::array<std::vector<float>, 2> renderThroughPlugin (VonicRewriteAudioProcessor& processor,
+                                                               const std::vector<float>& input, double sampleRate)
+{
+    processor.setPlayConfigDetails (2, 2, sampleRate, blockSize);
+    // Rendered as fast as it goes, so no quality is traded for time, and
+    // bit-identically on any machine.
+    processor.setNonRealtime (true);
+    processor.setDeterministic (true);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    std::array<std::vector<float>, 2> output;
+
+    for (auto& channel : output)
+        channel.resize (input.size());
+
+    for (int start = 0; start < (int) input.size(); start += blockSize)
+    {
+        const auto numSamples = juce::jmin (blockSize, (int) input.size() - start);
+        buffer.setSize (2, numSamples, false, false, true);
+
+        for (int ch = 0; ch < 2; ++ch)
+            buffer.copyFrom (ch, 0, input.data() + start, numSamples);
+
+        processor.processBlock (buffer, midi);
+
+        for (int ch = 0; ch < 2; ++ch)
+            std::copy (buffer.getReadPointer (ch), buffer.getReadPointer (ch) + numSamples, output[(size_t) ch].begin() + start);
+    }
+
+    processor.releaseResources();
+    return output;
+}
+
+//==============================================================================
+static constexpr int fileMagic = 0x32524756; // "VGR2"
+
+static juce::File getReferenceFile (const juce::File& directory, const juce::String& caseName)
+{
+    return directory.getChildFile (caseName + ".golden");
+}
+
+static bool writeReferenceFile (const juce::File& file, double sampleRate, const std::vector<float>& samples)
+{
+    file.deleteFile();
+    juce::FileOutputStream stream (file);
+
+    if (! stream.openedOk())
+        return false;
+
+    stream.writeInt (fileMagic);
+    stream.writeInt ((int) samples.size());
+    stream.writeDouble (sampleRate);
+
+    for (auto sample : samples)
+        stream.writeFloat (sample);
+
+    stream.flush();
+    return stream.getStatus().wasOk();
+}
+
+static juce::String readReferenceFile (const juce::File& file, double sampleRate, std::vector<float>& samples)
+{
+    juce::FileInputStream stream (file);
+
+    if (! stream.openedOk())
+        return "missing " + file.getFileName() + ", run --write-golden on a known-good build first";
+
+    if (stream.readInt() != fileMagic)
+        return file.getFileName() + " is not a reference file";
+
+    const auto numSamples = stream.readInt();
+
+    if (numSamples != signalLength || stream.readDouble() != sampleRate)
+        return file.getFileName() + " was written for a different signal length or sample rate";
+
+    samples.resize ((size_t) numSamples);
+
+    for (auto& sample : samples)
+        sample = stream.readFloat();
+
+    return stream.isExhausted() ? juce::String() : file.getFileName() + " has trailing data";
+}
+
+//==============================================================================
+/** Distance between two floats counted in representable values. */
+static juce::int64 getUlpDistance (float a, float b) noexcept
+{
+    auto toOrdered = [] (float f)
+    {
+        juce::int32 bits;
+        std::memcpy (&bits, &f, sizeof (bits));
+        return bits < 0 ? -(juce::int64) (bits & 0x7fffffff) : (juce::int64) bits;
+    };
+
+    return std::abs (toOrdered (a) - toOrdered (b));
+}
+
+static void compare (const std::vector<float>& output, const std::vector<float>& reference,
+                     const Tolerance& tolerance, Result& result)
+{
+    double peak = 0.0;
+
+    for (auto sample : reference)
+        peak = juce::jmax (peak, (double) std::abs (sample));
+
+    peak = juce::jmax (peak, 1.0e-30);
+
+    for (size_t n = 0; n < output.size(); ++n)
+    {
+        const auto error = std::abs ((double) output[n] - (double) reference[n]);
+        const auto ulps = getUlpDistance (output[n], reference[n]);
+
+        // Only reported, to tell a rounding difference from a broken filter.
+        result.worstErrorDb = juce::jmax (result.worstErrorDb, 20.0 * std::log10 (juce::jmax (error / peak, 1.0e-20)));
+        result.worstUlps = juce::jmax (result.worstUlps, ulps);
+
+        if (ulps > tolerance.maxUlps)
+            ++result.numFailingSamples;
+    }
+}
+
+template <typename Callback>
+static void forEachCase (Callback&& callback)
+{
+    for (auto& parameters : parameterCases)
+    {
+        for (auto sampleRate : sampleRates)
+        {
+            VonicRewriteAudioProcessor processor;
+            applyParameters (processor, parameters);
+
+            for (auto signal : signals)
+            {
+                const auto name = juce::String (parameters.name) + "-" + getSignalName (signal) + "-" + juce::String ((int) sampleRate);
+                callback (name, processor, makeSignal (signal, sampleRate), sampleRate);
+            }
+        }
+    }
+}
+
+//==============================================================================
+juce::String writeReferences (const juce::File& directory)
+{
+    if (! directory.createDirectory())
+        return "Couldn't create " + directory.getFullPathName();
+
+    juce::String error;
+
+    forEachCase ([&] (const juce::String& name, VonicRewriteAudioProcessor& processor,
+                      const std::vector<float>& input, double sampleRate)
+    {
+        if (error.isNotEmpty())
+            return;
+
+        // Both channels run the same signal, so one is kept.
+        const auto output = renderThroughPlugin (processor, input, sampleRate);
+        const auto file = getReferenceFile (directory, name);
+
+        if (output[0] != output[1])
+            error = name + " came out differently on its two channels";
+        else if (! writeReferenceFile (file, sampleRate, output[0]))
+            error = "Couldn't write " + file.getFullPathName();
+    });
+
+    return error;
+}
+
+juce::Array<Result> verify (const juce::File& directory, const Tolerance& tolerance)
+{
+    juce::Array<Result> results;
+
+    forEachCase ([&] (const juce::String& name, VonicRewriteAudioProcessor& processor,
+                      const std::vector<float>& input, double sampleRate)
+    {
+        Result result;
+        result.caseName = name;
+
+        std::vector<float> reference;
+        result.error = readReferenceFile (getReferenceFile (directory, name), sampleRate, reference);
+
+        if (result.error.isEmpty())
+        {
+            // Both channels run the same signal, and must both match.
+            for (auto& channel : renderThroughPlugin (processor, input, sampleRate))
+                compare (channel, reference, tolerance, result);
+
+            result.passed = result.numFailingSamples == 0;
+        }
+
+        results.add (result);
+    });
+
+    return results;
+}
+
+} // namespace GoldenReference
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    GoldenReference.h
+
+    Regression check for the DSP path. A fixed set of signals (impulse, log
+    sweep, seeded noise) is pushed through a real VonicRewriteAudioProcessor
+    in deterministic mode, at every slope and at the edges of each
+    parameter's range, and the result is compared against reference renders
+    stored in Tests/Golden. Deterministic renders are bit-identical on every
+    machine, and the signals are made without libm, so the references hold
+    everywhere and any change to processBlock, the kernels or FastDesign
+    that moves a single sample shows up as a failing case.
+
+    The libm designer the plugin normally runs isn't covered: its last bits
+    differ between platforms, so it can't be held to stored samples.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+namespace GoldenReference
+{
+    /** A sample passes when it is within maxUlps of the reference. The
+        references are bit-exact, so by default nothing may move at all; a
+        change that is meant to move the output writes new references.
+    */
+    struct Tolerance
+    {
+        int maxUlps = 0;
+    };
+
+    struct Result
+    {
+        juce::String caseName;
+        bool passed = false;
+
+        /** Set instead of the figures below when the case couldn't be run. */
+        juce::String error;
+
+        double worstErrorDb = -400.0;
+        juce::int64 worstUlps = 0;
+        int numFailingSamples = 0;
+    };
+
+    /** Renders every case through the plugin and stores it in directory,
+        returning an error message on failure.
+    */
+    juce::String writeReferences (const juce::File& directory);
+
+    /** Renders every case through the plugin and compares it against the
+        references in directory, one Result per case.
+    */
+    juce::Array<Result> verify (const juce::File& directory, const Tolerance& tolerance);
+}
@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    LiveAudio.cpp
+
+  ==============================================================================
+*/
+
+#include "LiveAudio.h"
+
+#if JUCE_LINUX || JUCE_BSD
+ #include <pthread.h>
+ #include <sched.h>
+ #include <sys/mman.h>
+#endif
+
+static constexpr float clickLevel = 0.5f, clickThreshold = 0.1f;
+
+//==============================================================================
+bool LiveAudio::Options::isEnabled() const noexcept
+{
+    return deviceType.isNotEmpty() || bufferSize > 0 || sampleRate > 0.0 || realtimePriority > 0
+        || cpu >= 0 || lockMemory || measureLatency;
+}
+
+LiveAudio::Options LiveAudio::Options::parse (const juce::ArgumentList& args)
+{
+    Options options;
+
+    if (args.containsOption ("--audio-type"))
+        options.deviceType = args.getValueForOption ("--audio-type");
+
+    if (args.containsOption ("--buffer-size"))
+        options.bufferSize = juce::jmax (0, args.getValueForOption ("--buffer-size").getIntValue());
+
+    if (args.containsOption ("--sample-rate"))
+        options.sampleRate = juce::jmax (0.0, args.getValueForOption ("--sample-rate").getDoubleValue());
+
+    if (args.containsOption ("--rt-priority"))
+        options.realtimePriority = juce::jlimit (0, 99, args.getValueForOption ("--rt-priority").getIntValue());
+
+    if (args.containsOption ("--cpu"))
+        options.cpu = juce::jmax (-1, args.getValueForOption ("--cpu").getIntValue());
+
+    options.lockMemory = args.containsOption ("--lock-memory");
+    options.measureLatency = args.containsOption ("--measure-latency");
+    return options;
+}
+
+juce::String LiveAudio::Options::getHelpText()
+{
+    return "Live options, when started without a command:\n"
+           "  --audio-type=<ALSA|JACK>   audio backend to open\n"
+           "  --buffer-size=<samples>    device buffer size (under JACK, set by jackd instead)\n"
+           "  --sample-rate=<Hz>         device sample rate\n"
+           "  --rt-priority=<1-99>       run the audio thread as SCHED_FIFO at this priority\n"
+           "  --cpu=<n>                  pin the audio thread to core n, ideally one kept free with isolcpus\n"
+           "  --lock-memory              lock the process's memory with mlockall\n"
+           "  --measure-latency          time a click from output 1 back to input 1 (needs a loopback cable)\n"
+           "The latency and xrun count are printed every 5 seconds when any of these are given.\n";
+}
+
+//==============================================================================
+LiveAudio::LiveAudio (juce::AudioDeviceManager& dm, const Options& o)
+    : deviceManager (dm), options (o)
+{
+   #if JUCE_LINUX || JUCE_BSD
+    if (options.lockMemory && mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+        std::cerr << "Couldn't lock memory: " << std::strerror (errno) << " (check ulimit -l)" << std::endl;
+   #endif
+
+    if (options.deviceType.isNotEmpty())
+    {
+        deviceManager.setCurrentAudioDeviceType (options.deviceType, true);
+
+        if (deviceManager.getCurrentAudioDeviceType() != options.deviceType)
+            std::cerr << "Audio type " << options.deviceType << " isn't available" << std::endl;
+    }
+
+    if (options.bufferSize > 0 || options.sampleRate > 0.0)
+    {
+        auto setup = deviceManager.getAudioDeviceSetup();
+
+        if (options.bufferSize > 0)
+            setup.bufferSize = options.bufferSize;
+
+        if (options.sampleRate > 0.0)
+            setup.sampleRate = options.sampleRate;
+
+        const auto error = deviceManager.setAudioDeviceSetup (setup, true);
+
+        if (error.isNotEmpty())
+            std::cerr << "Couldn't open the audio device: " << error << std::endl;
+    }
+
+    deviceManager.addAudioCallback (this);
+    startTimer (5000);
+}
+
+LiveAudio::~LiveAudio()
+{
+    stopTimer();
+    deviceManager.removeAudioCallback (this);
+}
+
+//==============================================================================
+void LiveAudio::audioDeviceAboutToStart (juce::AudioIODevice* device)
+{
+    // The backend may run the new device on a new thread.
+    threadNeedsSetUp = true;
+    samplesPerClick = juce::roundToInt (device->getCurrentSampleRate());
+    samplesUntilClick = samplesPerClick;
+    samplesSinceClick = -1;
+}
+
+void LiveAudio::audioDeviceStopped() {}
+
+void LiveAudio::audioDeviceIOCallbackWithContext (const float* const* inputChannelData, int numInputChannels,
+                                                  float* const* outputChannelData, int numOutputChannels,
+                                                  int numSamples, const juce::AudioIODeviceCallbackContext&)
+{
+    if (threadNeedsSetUp.exchange (false))
+        setUpAudioThread();
+
+    // The device manager adds our output to the processor's, so it has to be silent.
+    for (int i = 0; i < numOutputChannels; ++i)
+        if (outputChannelData[i] != nullptr)
+            juce::FloatVectorOperations::clear (outputChannelData[i], numSamples);
+
+    if (options.measureLatency && numInputChannels > 0 && numOutputChannels > 0
+         && inputChannelData[0] != nullptr && outputChannelData[0] != nullptr)
+        measureLatency (inputChannelData[0], outputChannelData[0], numSamples);
+}
+
+void LiveAudio::setUpAudioThread() noexcept
+{
+   #if JUCE_LINUX || JUCE_BSD
+    if (options.realtimePriority > 0)
+    {
+        sched_param param {};
+        param.sched_priority = options.realtimePriority;
+        priorityError = pthread_setschedparam (pthread_self(), SCHED_FIFO, &param);
+    }
+
+    if (options.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO (&cpus);
+        CPU_SET (options.cpu, &cpus);
+        affinityError = pthread_setaffinity_np (pthread_self(), sizeof (cpus), &cpus);
+    }
+   #endif
+}
+
+void LiveAudio::measureLatency (const float* input, float* output, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (samplesSinceClick >= 0)
+        {
+            ++samplesSinceClick;
+
+            if (std::abs (input[i]) > clickThreshold)
+            {
+                measuredLatency = samplesSinceClick;
+                samplesSinceClick = -1;
+            }
+            else if (samplesSinceClick > samplesPerClick / 2)
+            {
+                ++numLostClicks;
+                samplesSinceClick = -1;
+            }
+        }
+
+        if (--samplesUntilClick <= 0)
+        {
+            output[i] = clickLevel;
+            samplesUntilClick = samplesPerClick;
+            samplesSinceClick = 0;
+        }
+    }
+}
+
+//==============================================================================
+void LiveAudio::timerCallback()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+
+    if (device == nullptr)
+    {
+        std::cout << "No audio device open" << std::endl;
+        return;
+    }
+
+    if (! reportedThreadErrors && (priorityError != 0 || affinityError != 0))
+    {
+        reportedThreadErrors = true;
+
+        if (priorityError != 0)
+            std::cerr << "Couldn't set SCHED_FIFO priority " << options.realtimePriority << ": "
+                      << std::strerror (priorityError) << " (check ulimit -r)" << std::endl;
+
+        if (affinityError != 0)
+            std::cerr << "Couldn't pin the audio thread to core " << options.cpu << ": " << std::strerror (affinityError) << std::endl;
+    }
+
+    const auto sampleRate = device->getCurrentSampleRate();
+    const auto bufferSize = device->getCurrentBufferSizeSamples();
+    const auto toMilliseconds = [sampleRate] (int samples) { return juce::String (1000.0 * samples / sampleRate, 2) + " ms"; };
+
+    std::cout << device->getTypeName() << " \"" << device->getName() << "\", " << bufferSize << " samples at " << sampleRate << " Hz"
+              << ", reported round trip " << toMilliseconds (device->getInputLatencyInSamples() + device->getOutputLatencyInSamples());
+
+    if (options.measureLatency)
+    {
+        const auto latency = measuredLatency.load();
+        std::cout << ", measured " << (latency >= 0 ? toMilliseconds (latency) : juce::String ("nothing yet"));
+
+        if (const auto lost = numLostClicks.load(); lost > 0)
+            std::cout << " (" << lost << " clicks lost)";
+    }
+
+    const auto xruns = device->getXRunCount();
+
+    if (xruns >= 0)
+    {
+        std::cout << ", " << xruns << " xruns (+" << juce::jmax (0, xruns - lastXRunCount) << ")";
+        lastXRunCount = xruns;
+    }
+    else
+    {
+        std::cout << ", xruns not reported by this backend";
+    }
+
+    std::cout << std::endl;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    LiveAudio.h
+
+    Live-use settings for the standalone build on Linux: which backend and
+    buffer size to open, realtime scheduling and CPU pinning for the audio
+    thread, locked memory, and a periodic report of the device's latency and
+    xruns on stdout.
+
+        VonicForContribs --audio-type=ALSA --buffer-size=64 --rt-priority=80 --cpu=3 --lock-memory
+
+    The period count isn't among the options because JUCE doesn't expose it:
+    the ALSA backend picks its own, and under JACK it's jackd's -n setting.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class LiveAudio  : private juce::AudioIODeviceCallback,
+                   private juce::Timer
+{
+public:
+    struct Options
+    {
+        juce::String deviceType;
+        int bufferSize = 0;
+        double sampleRate = 0.0;
+
+        /** SCHED_FIFO priority for the audio thread, or 0 to leave it alone. */
+        int realtimePriority = 0;
+
+        /** Core to pin the audio thread to, or -1 to leave it alone. */
+        int cpu = -1;
+
+        bool lockMemory = false;
+
+        /** Sends a click out of output 1 every second and times how long it
+            takes to come back on input 1. Needs a loopback cable.
+        */
+        bool measureLatency = false;
+
+        /** True if any option was given, in which case the report is printed. */
+        bool isEnabled() const noexcept;
+
+        static Options parse (const juce::ArgumentList& args);
+        static juce::String getHelpText();
+    };
+
+    /** Applies the options to an open device manager and starts reporting.
+        Problems are printed to stderr rather than stopping the app.
+    */
+    LiveAudio (juce::AudioDeviceManager& deviceManager, const Options& options);
+    ~LiveAudio() override;
+
+private:
+    void audioDeviceAboutToStart (juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+    void audioDeviceIOCallbackWithContext (const float* const* inputChannelData, int numInputChannels,
+                                           float* const* outputChannelData, int numOutputChannels,
+                                           int numSamples, const juce::AudioIODeviceCallbackContext& context) override;
+    void timerCallback() override;
+
+    void setUpAudioThread() noexcept;
+    void measureLatency (const float* input, float* output, int numSamples) noexcept;
+
+    juce::AudioDeviceManager& deviceManager;
+    const Options options;
+
+    // Written on the audio thread, read by the report.
+    std::atomic<bool> threadNeedsSetUp { true };
+    std::atomic<int> priorityError { 0 }, affinityError { 0 };
+    std::atomic<int> measuredLatency { -1 }, numLostClicks { 0 };
+
+    // Audio thread only, apart from audioDeviceAboutToStart().
+    int samplesUntilClick = 0, samplesSinceClick = -1, samplesPerClick = 48000;
+
+    // Message thread only.
+    int lastXRunCount = 0;
+    bool reportedThreadErrors = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LiveAudio)
+};
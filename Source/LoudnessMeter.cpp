@@ -0,0 +1,424 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+#include "BlockCascade.h"
+
+static juce::String formatLevel (float level)
+{
+    return std::isfinite (level) ? juce::String (level, 1) : juce::String ("-inf");
+}
+
+juce::String LoudnessMeter::Readings::toString() const
+{
+    return "M " + formatLevel (momentary) + "  S " + formatLevel (shortTerm) + "  I " + formatLevel (integrated)
+         + " LUFS  TP " + formatLevel (truePeak) + " dBTP";
+}
+
+LoudnessMeter::LoudnessMeter() = default;
+LoudnessMeter::~LoudnessMeter() = default;
+
+//==============================================================================
+ChainCoefficients LoudnessMeter::designKWeighting (double sampleRate)
+{
+    // The recommendation only lists coefficients for 48 kHz; these are the
+    // analogue prototypes they came from, which give exactly those there.
+    const auto bilinear = [sampleRate] (double frequency) { return std::tan (juce::MathConstants<double>::pi * frequency / sampleRate); };
+
+    ChainCoefficients chain;
+
+    {
+        const auto k = bilinear (1681.974450955533), q = 0.7071752369554196;
+        const auto vh = std::pow (10.0, 3.999843853973347 / 20.0);
+        const auto vb = std::pow (vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+
+        auto& shelf = chain.peak;
+        shelf.b0 = (float) ((vh + vb * k / q + k * k) / a0);
+        shelf.b1 = (float) (2.0 * (k * k - vh) / a0);
+        shelf.b2 = (float) ((vh - vb * k / q + k * k) / a0);
+        shelf.a1 = (float) (2.0 * (k * k - 1.0) / a0);
+        shelf.a2 = (float) ((1.0 - k / q + k * k) / a0);
+    }
+
+    {
+        const auto k = bilinear (38.13547087602444), q = 0.5003270373238773;
+        const auto a0 = 1.0 + k / q + k * k;
+
+        auto& highPass = chain.lowCut[0];
+        highPass.b0 = 1.0f;
+        highPass.b1 = -2.0f;
+        highPass.b2 = 1.0f;
+        highPass.a1 = (float) (2.0 * (k * k - 1.0) / a0);
+        highPass.a2 = (float) ((1.0 - k / q + k * k) / a0);
+        chain.numLowCut = 1;
+    }
+
+    return chain;
+}
+
+//==============================================================================
+void LoudnessMeter::prepare (double sampleRate, int newNumChannels, int newMaxBlockSize,
+                             bool measureTruePeak, bool shouldBeDeterministic)
+{
+    numChannels = newNumChannels;
+    maxBlockSize = juce::jmax (1, newMaxBlockSize);
+    stepLength = getStepLength (sampleRate);
+    deterministic = shouldBeDeterministic;
+    truePeakEnabled = measureTruePeak;
+
+    const auto kWeighting = designKWeighting (sampleRate);
+    blockFilters.clear();
+    scalarFilters.assign ((size_t) (deterministic ? numChannels : 0), {});
+
+    for (auto& filter : scalarFilters)
+        filter.setCoefficients (kWeighting);
+
+    for (int ch = 0; ch < numChannels && ! deterministic; ++ch)
+    {
+        blockFilters.push_back (std::make_unique<BlockCascade>());
+        blockFilters.back()->setCoefficients (kWeighting);
+    }
+
+    weights.assign ((size_t) numChannels, 1.0f);
+
+    if (numChannels == 6)
+    {
+        weights[3] = 0.0f;
+        weights[4] = weights[5] = 1.41f;
+    }
+
+    scratch.resize ((size_t) (numChannels * maxBlockSize));
+    maxSectionsPerBlock = maxBlockSize / stepLength + 2;
+    blockEnergies.resize ((size_t) (numChannels * maxSectionsPerBlock));
+
+    oversampling = sampleRate < 88200.0 ? 4 : sampleRate < 176400.0 ? 2 : 1;
+    phases.resize ((size_t) (oversampling * tapsPerPhase));
+
+    // A Hann-windowed sinc cutting off at the original Nyquist, split into
+    // one set of taps per output phase, each normalised to unity at DC.
+    const auto length = oversampling * tapsPerPhase;
+    const auto centre = (length - 1) * 0.5;
+
+    for (int phase = 0; phase < oversampling; ++phase)
+    {
+        auto* taps = phases.data() + phase * tapsPerPhase;
+        double sum = 0.0;
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+        {
+            // Tap k multiplies the k-th oldest of the last tapsPerPhase samples.
+            const auto n = phase + oversampling * (tapsPerPhase - 1 - k);
+            const auto x = (n - centre) / oversampling;
+            const auto sinc = x == 0.0 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            const auto window = 0.5 - 0.5 * std::cos (juce::MathConstants<double>::twoPi * (n + 0.5) / length);
+            taps[k] = (float) (sinc * window);
+            sum += taps[k];
+        }
+
+        for (int k = 0; k < tapsPerPhase; ++k)
+            taps[k] = (float) (taps[k] / sum);
+    }
+
+    truePeakHistory.resize ((size_t) (numChannels * 2 * tapsPerPhase));
+    truePeaks.resize ((size_t) numChannels);
+    truePeakPositions.resize ((size_t) numChannels);
+
+    reset();
+}
+
+void LoudnessMeter::reset() noexcept
+{
+    for (auto& filter : blockFilters)
+        filter->reset();
+
+    for (auto& filter : scalarFilters)
+        filter.reset();
+
+    std::fill (truePeakHistory.begin(), truePeakHistory.end(), 0.0f);
+    std::fill (truePeakPositions.begin(), truePeakPositions.end(), 0);
+
+    clearMeasurements();
+}
+
+void LoudnessMeter::clearMeasurements() noexcept
+{
+    steps.fill (0.0);
+    stepIndex = numSteps = stepPosition = 0;
+    stepEnergy = 0.0;
+
+    binEnergies.fill (0.0);
+    binCounts.fill (0);
+
+    std::fill (truePeaks.begin(), truePeaks.end(), 0.0f);
+
+    for (auto* reading : { &momentary, &shortTerm, &integrated, &truePeak })
+        reading->store (-std::numeric_limits<float>::infinity(), std::memory_order_relaxed);
+}
+
+LoudnessMeter::Readings LoudnessMeter::getReadings() const noexcept
+{
+    Readings readings;
+    readings.momentary = momentary.load (std::memory_order_relaxed);
+    readings.shortTerm = shortTerm.load (std::memory_order_relaxed);
+    readings.integrated = integrated.load (std::memory_order_relaxed);
+    readings.truePeak = truePeak.load (std::memory_order_relaxed);
+    return readings;
+}
+
+//==============================================================================
+/** Eight running sums instead of one, so that the loop vectorises without
+    reordering anything (and so gives the same result with or without SIMD).
+*/
+static double getSumOfSquares (const float* samples, int numSamples) noexcept
+{
+    float lanes[8] {};
+    int i = 0;
+
+    for (; i + 8 <= numSamples; i += 8)
+        for (int j = 0; j < 8; ++j)
+            lanes[j] += samples[i + j] * samples[i + j];
+
+    double sum = 0.0;
+
+    for (; i < numSamples; ++i)
+        sum += (double) samples[i] * samples[i];
+
+    for (auto lane : lanes)
+        sum += lane;
+
+    return sum;
+}
+
+void LoudnessMeter::process (const float* const* channels, int numSamples) noexcept
+{
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize)
+    {
+        const auto length = juce::jmin (maxBlockSize, numSamples - offset);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            processChannel (ch, channels[ch] + offset, length);
+
+        endBlock (length);
+    }
+}
+
+void LoudnessMeter::processChannel (int channel, const float* samples, int numSamples) noexcept
+{
+    jassert (numSamples <= maxBlockSize);
+
+    if (truePeakEnabled)
+        measureTruePeak (channel, samples, numSamples);
+
+    const auto weight = weights[(size_t) channel];
+
+    if (weight == 0.0f)
+        return;
+
+    auto* weighted = scratch.data() + channel * maxBlockSize;
+    auto* energies = blockEnergies.data() + channel * maxSectionsPerBlock;
+    std::copy (samples, samples + numSamples, weighted);
+
+    if (deterministic)
+        scalarFilters[(size_t) channel].process (weighted, numSamples);
+    else
+        blockFilters[(size_t) channel]->process (weighted, numSamples);
+
+    // The block is cut where it crosses from one 100 ms step into the next.
+    // Only endBlock() moves stepPosition, so every channel cuts it the same.
+    const auto firstLength = juce::jmin (numSamples, stepLength - stepPosition);
+
+    for (int k = 0, start = 0, length = firstLength; start < numSamples; ++k, start += length, length = juce::jmin (stepLength, numSamples - start))
+        energies[k] = weight * getSumOfSquares (weighted + start, length);
+}
+
+void LoudnessMeter::endBlock (int numSamples) noexcept
+{
+    const auto firstLength = juce::jmin (numSamples, stepLength - stepPosition);
+
+    for (int k = 0, start = 0, length = firstLength; start < numSamples; ++k, start += length, length = juce::jmin (stepLength, numSamples - start))
+    {
+        // Summed in channel order, whichever order the channels came in.
+        double energy = 0.0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (weights[(size_t) ch] != 0.0f)
+                energy += blockEnergies[(size_t) (ch * maxSectionsPerBlock + k)];
+
+        addToStep (energy, length);
+    }
+
+    if (truePeakEnabled)
+        truePeak.store (juce::Decibels::gainToDecibels (getTruePeakGain(), -std::numeric_limits<float>::infinity()), std::memory_order_relaxed);
+}
+
+void LoudnessMeter::addSilence (int numSamples) noexcept
+{
+    // Whatever the filters still hold has long since died away.
+    for (auto& filter : blockFilters)
+        filter->reset();
+
+    for (auto& filter : scalarFilters)
+        filter.reset();
+
+    std::fill (truePeakHistory.begin(), truePeakHistory.end(), 0.0f);
+
+    while (numSamples > 0)
+    {
+        const auto length = juce::jmin (numSamples, stepLength - stepPosition);
+        addToStep (0.0, length);
+        numSamples -= length;
+    }
+}
+
+void LoudnessMeter::addTruePeak (float gain) noexcept
+{
+    if (truePeaks.empty())
+        return;
+
+    truePeaks[0] = juce::jmax (truePeaks[0], gain);
+    truePeak.store (juce::Decibels::gainToDecibels (getTruePeakGain(), -std::numeric_limits<float>::infinity()), std::memory_order_relaxed);
+}
+
+float LoudnessMeter::getTruePeakGain() const noexcept
+{
+    return truePeaks.empty() ? 0.0f : *std::max_element (truePeaks.begin(), truePeaks.end());
+}
+
+void LoudnessMeter::measureTruePeak (int channel, const float* samples, int numSamples) noexcept
+{
+    auto peak = truePeaks[(size_t) channel];
+
+    if (oversampling == 1)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            peak = juce::jmax (peak, std::abs (samples[i]));
+
+        truePeaks[(size_t) channel] = peak;
+        return;
+    }
+
+    auto* history = truePeakHistory.data() + channel * 2 * tapsPerPhase;
+    auto position = truePeakPositions[(size_t) channel];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = samples[i];
+        history[position] = history[position + tapsPerPhase] = x;
+        position = position + 1 == tapsPerPhase ? 0 : position + 1;
+
+        // Oldest to newest.
+        const auto* recent = history + position;
+        peak = juce::jmax (peak, std::abs (x));
+
+        for (int phase = 0; phase < oversampling; ++phase)
+        {
+            const auto* taps = phases.data() + phase * tapsPerPhase;
+            auto y = 0.0f;
+
+            for (int k = 0; k < tapsPerPhase; ++k)
+                y += taps[k] * recent[k];
+
+            peak = juce::jmax (peak, std::abs (y));
+        }
+    }
+
+    truePeaks[(size_t) channel] = peak;
+    truePeakPositions[(size_t) channel] = position;
+}
+
+//==============================================================================
+float LoudnessMeter::toLufs (double energy) noexcept
+{
+    return energy > 0.0 ? (float) (-0.691 + 10.0 * std::log10 (energy))
+                        : -std::numeric_limits<float>::infinity();
+}
+
+void LoudnessMeter::addToStep (double energy, int numSamples) noexcept
+{
+    stepEnergy += energy;
+    stepPosition += numSamples;
+
+    if (stepPosition < stepLength)
+        return;
+
+    const auto meanSquare = stepEnergy / stepLength;
+    stepEnergy = 0.0;
+    stepPosition = 0;
+
+    if (log != nullptr)
+        log->push_back (meanSquare);
+
+    addStep (meanSquare);
+}
+
+void LoudnessMeter::addStep (double meanSquare) noexcept
+{
+    jassert (stepPosition == 0);
+
+    stepIndex = (stepIndex + 1) % shortTermSteps;
+    steps[(size_t) stepIndex] = meanSquare;
+    numSteps = juce::jmin (numSteps + 1, shortTermSteps);
+
+    double momentaryEnergy = 0.0, shortTermEnergy = 0.0;
+
+    for (int i = 0; i < shortTermSteps; ++i)
+    {
+        const auto energy = steps[(size_t) ((stepIndex - i + shortTermSteps) % shortTermSteps)];
+        shortTermEnergy += energy;
+
+        if (i < momentarySteps)
+            momentaryEnergy += energy;
+    }
+
+    // Before the first 400 ms and 3 s, the missing steps count as silence.
+    momentaryEnergy /= momentarySteps;
+    shortTermEnergy /= shortTermSteps;
+
+    momentary.store (toLufs (momentaryEnergy), std::memory_order_relaxed);
+    shortTerm.store (toLufs (shortTermEnergy), std::memory_order_relaxed);
+
+    // Every momentary window is also a gating block, once it is complete.
+    const auto blockLoudness = toLufs (momentaryEnergy);
+
+    if (numSteps >= momentarySteps && blockLoudness > absoluteGate)
+    {
+        const auto bin = juce::jlimit (0, numBins - 1, (int) ((blockLoudness - absoluteGate) * binsPerLU));
+        binEnergies[(size_t) bin] += momentaryEnergy;
+        ++binCounts[(size_t) bin];
+        updateIntegrated();
+    }
+}
+
+void LoudnessMeter::updateIntegrated() noexcept
+{
+    double totalEnergy = 0.0;
+    juce::uint64 totalCount = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        totalEnergy += binEnergies[(size_t) bin];
+        totalCount += binCounts[(size_t) bin];
+    }
+
+    const auto gate = toLufs (totalEnergy / (double) totalCount) + relativeGate;
+    double gatedEnergy = 0.0;
+    juce::uint64 gatedCount = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        if (absoluteGate + (bin + 0.5f) / binsPerLU < gate)
+            continue;
+
+        gatedEnergy += binEnergies[(size_t) bin];
+        gatedCount += binCounts[(size_t) bin];
+    }
+
+    if (gatedCount > 0)
+        integrated.store (toLufs (gatedEnergy / (double) gatedCount), std::memory_order_relaxed);
+}
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+
+    ITU-R BS.1770-4 loudness and true peak of a multichannel signal, fed a
+    block at a time:
+
+    - each channel is K-weighted (a high shelf and a high-pass) by the
+      same kernels that run the EQ, BlockCascade, or Cascade when the
+      meter has to be deterministic;
+    - the weighted channels' mean squares are summed every 100 ms, with
+      weight 1.41 on the surrounds of a 5.1 signal (L R C LFE Ls Rs, the LFE
+      left out) and 1 on every channel otherwise;
+    - momentary and short-term loudness average the last 4 and 30 of those
+      steps (400 ms and 3 s);
+    - integrated loudness gates the 400 ms blocks, one every 100 ms, at
+      -70 LUFS and then at 10 LU below their mean. The blocks go into a
+      fixed histogram of 0.1 LU bins that keeps each bin's total energy, so
+      nothing is allocated or stored per block however long the programme;
+      only a bin straddling the relative gate is counted as a whole;
+    - true peak is the largest sample after oversampling (4x below 88.2 kHz,
+      2x below 176.4 kHz) through a 12-tap-per-phase windowed-sinc
+      interpolator, like the one in the recommendation's Annex 2.
+
+    prepare() allocates everything; process() and addSilence() don't, so
+    they can run on the audio thread. The readings are atomics, safe to
+    read from any thread.
+
+    process() can also be done a channel at a time, on different threads,
+    and a long programme can be measured in pieces on separate meters whose
+    steps are then replayed, in order, into one.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+class BlockCascade;
+
+class LoudnessMeter
+{
+public:
+    struct Readings
+    {
+        /** In LUFS, minus infinity until there is anything to measure. */
+        float momentary = -std::numeric_limits<float>::infinity();
+        float shortTerm = -std::numeric_limits<float>::infinity();
+        float integrated = -std::numeric_limits<float>::infinity();
+
+        /** Since the last reset, in dBTP. */
+        float truePeak = -std::numeric_limits<float>::infinity();
+
+        /** e.g. "M -18.2  S -19.0  I -19.4 LUFS  TP -1.2 dBTP". */
+        juce::String toString() const;
+    };
+
+    LoudnessMeter();
+    ~LoudnessMeter();
+
+    /** Not for the audio thread. Blocks longer than maxBlockSize are fine,
+        they're just measured in pieces.
+    */
+    void prepare (double sampleRate, int numChannels, int maxBlockSize,
+                  bool measureTruePeak = true, bool deterministic = false);
+
+    /** Starts the integrated loudness and true peak over. */
+    void reset() noexcept;
+
+    /** Measures the next numSamples of the prepared number of channels. */
+    void process (const float* const* channels, int numSamples) noexcept;
+
+    /** process() in parts: processChannel() for every channel, in any order
+        and on any threads, then endBlock() once they have all returned.
+        numSamples must be the same throughout and no more than the
+        maxBlockSize given to prepare(). The readings come out exactly as
+        process() would leave them.
+    */
+    void processChannel (int channel, const float* samples, int numSamples) noexcept;
+    void endBlock (int numSamples) noexcept;
+
+    /** The same as processing numSamples of digital silence, but without
+        running the filters.
+    */
+    void addSilence (int numSamples) noexcept;
+
+    Readings getReadings() const noexcept;
+
+    /** Whether the short-term loudness has a full 3 s behind it since the
+        last reset, rather than counting the missing time as silence.
+        Audio thread only.
+    */
+    bool isShortTermComplete() const noexcept   { return numSteps >= shortTermSteps; }
+
+    //==============================================================================
+    /** For measuring a programme in pieces. Each piece's meter is run over a
+        little of what comes before it, then has clearMeasurements() called
+        so that only its filters' state is kept; while stepLog is set, it
+        appends the mean square of every 100 ms step it finishes. Passing
+        each piece's steps to addStep() and its getTruePeakGain() to
+        addTruePeak() on another meter, in order, then measures the whole.
+        Pieces have to start on a step boundary (see getStepLength()).
+
+        These allocate, so aren't for the audio thread.
+    */
+    void clearMeasurements() noexcept;
+    void setStepLog (std::vector<double>* stepLog) noexcept   { log = stepLog; }
+    void addStep (double meanSquare) noexcept;
+    void addTruePeak (float gain) noexcept;
+    float getTruePeakGain() const noexcept;
+
+    /** Samples in each 100 ms step at this rate. */
+    static int getStepLength (double sampleRate) noexcept   { return juce::jmax (1, juce::roundToInt (sampleRate * 0.1)); }
+
+    /** The K-weighting filter at the given rate, as a chain the cascade
+        kernels can run: the high-pass in the first low cut slot, the shelf
+        in the peak slot.
+    */
+    static ChainCoefficients designKWeighting (double sampleRate);
+
+    static constexpr float absoluteGate = -70.0f, relativeGate = -10.0f;
+
+private:
+    void measureTruePeak (int channel, const float* samples, int numSamples) noexcept;
+    void addToStep (double energy, int numSamples) noexcept;
+    void updateIntegrated() noexcept;
+
+    static float toLufs (double energy) noexcept;
+
+    int numChannels = 0, maxBlockSize = 0, stepLength = 1;
+    bool deterministic = false;
+
+    // One of each per channel, depending on deterministic.
+    std::vector<std::unique_ptr<BlockCascade>> blockFilters;
+    std::vector<Cascade> scalarFilters;
+    std::vector<float> weights;
+
+    // maxBlockSize samples of K-weighted audio for each channel, so that
+    // channels can be measured at the same time.
+    std::vector<float> scratch;
+
+    // For each channel, the weighted energy of each section of the block
+    // being processed that falls in a different 100 ms step.
+    int maxSectionsPerBlock = 1;
+    std::vector<double> blockEnergies;
+
+    std::vector<double>* log = nullptr;
+
+    // The last 30 steps' energies, newest at stepIndex.
+    static constexpr int momentarySteps = 4, shortTermSteps = 30;
+    std::array<double, shortTermSteps> steps {};
+    int stepIndex = 0, numSteps = 0, stepPosition = 0;
+    double stepEnergy = 0.0;
+
+    // Gating blocks by loudness, from absoluteGate up to +10 LUFS (louder
+    // ones go in the top bin).
+    static constexpr int binsPerLU = 10, numBins = 80 * binsPerLU;
+    std::array<double, numBins> binEnergies {};
+    std::array<juce::uint32, numBins> binCounts {};
+
+    // Polyphase interpolator for true peak, with each channel's last
+    // tapsPerPhase samples stored twice so they can be read in one run.
+    static constexpr int tapsPerPhase = 12;
+    int oversampling = 1;
+    bool truePeakEnabled = true;
+    std::vector<float> phases, truePeakHistory, truePeaks;
+    std::vector<int> truePeakPositions;
+
+    std::atomic<float> momentary { -std::numeric_limits<float>::infinity() },
+                       shortTerm { -std::numeric_limits<float>::infinity() },
+                       integrated { -std::numeric_limits<float>::infinity() },
+                       truePeak { -std::numeric_limits<float>::infinity() };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessMeter)
+};
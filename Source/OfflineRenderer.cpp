@@ -0,0 +1,671 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "Determinism.h"
+#include "BlockCascade.h"
+#include "ParallelForm.h"
+#include "RenderPipeline.h"
+#include "RawPcm.h"
+
+OfflineRenderer::OfflineRenderer (const FilterSet& settingsToUse)
+    : settings (settingsToUse)
+{
+}
+
+//==============================================================================
+static bool designParallel (const ChainCoefficients& chain, double sampleRate, const OfflineRenderer::Options& options,
+                            ParallelCoefficients& parallel, OfflineRenderer::Report& report)
+{
+    if (options.deterministic || ! options.useParallelForm)
+        return false;
+
+    report.parallelForm = ParallelForm::design (chain, sampleRate, parallel);
+    report.parallelErrorDb = parallel.errorDb;
+    return report.parallelForm;
+}
+
+// In-memory renders filter and meter in blocks of this many samples.
+static constexpr int renderBlockSize = 1 << 16;
+
+OfflineRenderer::Report OfflineRenderer::render (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                                 double sampleRate, const Options& options) const
+{
+    juce::ScopedNoDenormals noDenormals;
+    Report report;
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const auto chain = design (sampleRate, options);
+
+    ParallelCoefficients parallelCoefficients;
+    const auto* parallel = designParallel (chain, sampleRate, options, parallelCoefficients, report) ? &parallelCoefficients : nullptr;
+
+    output.setSize (input.getNumChannels(), input.getNumSamples(), false, false, true);
+
+    LoudnessMeter inputMeter, outputMeter;
+
+    if (options.measureLoudness)
+    {
+        inputMeter.prepare (sampleRate, input.getNumChannels(), renderBlockSize, true, options.deterministic);
+        outputMeter.prepare (sampleRate, input.getNumChannels(), renderBlockSize, true, options.deterministic);
+    }
+
+    auto* inputMeterToUse = options.measureLoudness ? &inputMeter : nullptr;
+    auto* outputMeterToUse = options.measureLoudness ? &outputMeter : nullptr;
+
+    if (options.deterministic
+         || ! (options.splitIntoSegments && renderSegmented (input, output, chain, parallel, sampleRate, options, report,
+                                                             inputMeterToUse, outputMeterToUse)))
+    {
+        renderSerial (input, output, chain, parallel, options.deterministic, inputMeterToUse, outputMeterToUse);
+
+        // A segmented attempt that failed its seam check leaves its figures
+        // behind, and a serial render has no seams.
+        report.numSegments = 1;
+        report.preRollSamples = 0;
+        report.errorBound = 0.0;
+        report.measuredSeamError = 0.0;
+    }
+
+    if (options.deterministic)
+    {
+        Determinism::AudioHash hash;
+        hash.add (output);
+        report.outputHash = hash.toString();
+    }
+
+    if (options.measureLoudness)
+    {
+        report.inputLoudness = inputMeter.getReadings();
+        report.outputLoudness = outputMeter.getReadings();
+    }
+
+    report.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    return report;
+}
+
+ChainCoefficients OfflineRenderer::design (double sampleRate, const Options& options) const
+{
+    return options.deterministic ? Determinism::designChain (settings, sampleRate)
+                                 : designChain (settings, sampleRate);
+}
+
+namespace
+{
+    /** One channel's filter outside deterministic renders: the parallel form
+        if one was designed, otherwise the block kernel.
+    */
+    struct ChannelFilter
+    {
+        ChannelFilter (const ChainCoefficients& chain, const ParallelCoefficients* parallel)
+        {
+            if (parallel != nullptr)
+            {
+                parallelChain = std::make_unique<ParallelChain>();
+                parallelChain->setCoefficients (*parallel);
+            }
+            else
+            {
+                blockCascade = std::make_unique<BlockCascade>();
+                blockCascade->setCoefficients (chain);
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (parallelChain != nullptr)
+                parallelChain->reset();
+            else
+                blockCascade->reset();
+        }
+
+        void process (float* samples, int numSamples) noexcept
+        {
+            if (parallelChain != nullptr)
+                parallelChain->process (samples, numSamples);
+            else
+                blockCascade->process (samples, numSamples);
+        }
+
+        std::unique_ptr<BlockCascade> blockCascade;
+        std::unique_ptr<ParallelChain> parallelChain;
+    };
+}
+
+/** Goes through the buffer a block at a time, and each block a channel at a
+    time, so that the meters see every block on its way in and out while
+    it's still in cache.
+*/
+template <typename ChainType>
+static void filterChannels (std::vector<ChainType>& chains, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                            bool flushDenormals, LoudnessMeter* inputMeter, LoudnessMeter* outputMeter)
+{
+    const auto numSamples = input.getNumSamples();
+
+    for (auto& chain : chains)
+        chain.reset();
+
+    for (int start = 0; start < numSamples; start += renderBlockSize)
+    {
+        const auto length = juce::jmin (renderBlockSize, numSamples - start);
+
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+        {
+            auto* samples = output.getWritePointer (ch, start);
+
+            if (inputMeter != nullptr)
+                inputMeter->processChannel (ch, input.getReadPointer (ch, start), length);
+
+            output.copyFrom (ch, start, input, ch, start, length);
+
+            if (flushDenormals)
+                Determinism::flushDenormals (samples, length);
+
+            chains[(size_t) ch].process (samples, length);
+
+            if (flushDenormals)
+                Determinism::flushDenormals (samples, length);
+
+            if (outputMeter != nullptr)
+                outputMeter->processChannel (ch, samples, length);
+        }
+
+        for (auto* meter : { inputMeter, outputMeter })
+            if (meter != nullptr)
+                meter->endBlock (length);
+    }
+}
+
+void OfflineRenderer::renderSerial (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                    const ChainCoefficients& chain, const ParallelCoefficients* parallel, bool deterministic,
+                                    LoudnessMeter* inputMeter, LoudnessMeter* outputMeter) const
+{
+    // Deterministic renders stay on the scalar cascade, whose rounding is the
+    // same on every CPU; otherwise each channel runs several samples at once.
+    if (deterministic)
+    {
+        std::vector<Cascade> cascades ((size_t) input.getNumChannels());
+
+        for (auto& cascade : cascades)
+            cascade.setCoefficients (chain);
+
+        filterChannels (cascades, input, output, true, inputMeter, outputMeter);
+    }
+    else
+    {
+        std::vector<ChannelFilter> filters;
+
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+            filters.emplace_back (chain, parallel);
+
+        filterChannels (filters, input, output, false, inputMeter, outputMeter);
+    }
+}
+
+bool OfflineRenderer::renderSegmented (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                       const ChainCoefficients& chain, const ParallelCoefficients* parallel, double sampleRate,
+                                       const Options& options, Report& report,
+                                       LoudnessMeter* inputMeter, LoudnessMeter* outputMeter) const
+{
+    const auto numChannels = input.getNumChannels();
+    const auto numSamples = input.getNumSamples();
+    const auto measuring = inputMeter != nullptr && outputMeter != nullptr;
+    auto segmentLength = juce::jmax (1, juce::roundToInt (options.segmentSeconds * sampleRate));
+
+    // Each segment is measured on meters of its own, whose 100 ms steps are
+    // replayed into the real ones in order once they've all finished. For
+    // that the segments have to start on a step, and the meters' filters
+    // need half a second of what comes before to settle.
+    const auto stepLength = LoudnessMeter::getStepLength (sampleRate);
+    const auto meterPreRoll = measuring ? juce::roundToInt (sampleRate * 0.5) : 0;
+
+    if (measuring)
+        segmentLength = (segmentLength + stepLength - 1) / stepLength * stepLength;
+
+    const auto numSegments = (numSamples + segmentLength - 1) / segmentLength;
+
+    // Half the budget goes to the truncated tail; the rest is headroom for
+    // float rounding, which differs a little between the two renders.
+    double tailSum = 0.0;
+    const auto preRoll = getPreRollLength (chain, sampleRate, options.maxSegmentError * 0.5, tailSum);
+
+    if (numSegments < 2 || preRoll >= segmentLength)
+        return false;
+
+    float peak = 0.f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        peak = juce::jmax (peak, input.getMagnitude (ch, 0, numSamples));
+
+    report.numSegments = numSegments;
+    report.preRollSamples = preRoll;
+    report.errorBound = peak * tailSum;
+
+    // Every segment but the last also runs a little past its end. Its own
+    // output there has had far more settling time than the next segment's
+    // first samples, so comparing the two measures the seam error directly.
+    const auto seamCheckLength = juce::jlimit (1, 512, preRoll);
+    std::vector<juce::AudioBuffer<float>> seamChecks ((size_t) numSegments);
+
+    // AudioBuffer's accessors update its isClear flag, so the jobs can't call
+    // them on the shared output; they write through these instead.
+    auto* const* outputChannels = output.getArrayOfWritePointers();
+
+    struct SegmentLoudness
+    {
+        std::vector<double> inputSteps, outputSteps;
+        float inputPeak = 0.f, outputPeak = 0.f;
+    };
+
+    std::vector<SegmentLoudness> loudness ((size_t) (measuring ? numSegments : 0));
+
+    std::atomic<int> remaining { numSegments };
+    juce::WaitableEvent finished;
+    juce::ThreadPool pool (juce::jmax (1, juce::jmin (options.numThreads, numSegments)));
+
+    for (int k = 0; k < numSegments; ++k)
+    {
+        pool.addJob ([&, k]
+        {
+            const auto start = k * segmentLength;
+            const auto end = juce::jmin (numSamples, start + segmentLength);
+            const auto meterFrom = juce::jmax (0, start - meterPreRoll);
+            const auto from = juce::jmax (0, meterFrom - preRoll);
+            const auto to = k < numSegments - 1 ? juce::jmin (numSamples, end + seamCheckLength) : end;
+
+            juce::AudioBuffer<float> scratch (numChannels, to - from);
+            auto& seam = seamChecks[(size_t) k];
+            seam.setSize (numChannels, to - end);
+
+            // The parallel form has the same poles, so the same pre-roll.
+            ChannelFilter filter (chain, parallel);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                filter.reset();
+                scratch.copyFrom (ch, 0, input, ch, from, to - from);
+                filter.process (scratch.getWritePointer (ch), to - from);
+                juce::FloatVectorOperations::copy (outputChannels[ch] + start, scratch.getReadPointer (ch, start - from), end - start);
+                seam.copyFrom (ch, 0, scratch, ch, end - from, to - end);
+            }
+
+            if (measuring)
+            {
+                LoudnessMeter segmentInput, segmentOutput;
+                segmentInput.prepare (sampleRate, numChannels, renderBlockSize);
+                segmentOutput.prepare (sampleRate, numChannels, renderBlockSize);
+
+                std::vector<const float*> inputChannels ((size_t) numChannels), filteredChannels ((size_t) numChannels);
+
+                auto measure = [&] (int position, int length)
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                    {
+                        inputChannels[(size_t) ch] = input.getReadPointer (ch, position);
+                        filteredChannels[(size_t) ch] = scratch.getReadPointer (ch, position - from);
+                    }
+
+                    segmentInput.process (inputChannels.data(), length);
+                    segmentOutput.process (filteredChannels.data(), length);
+                };
+
+                measure (meterFrom, start - meterFrom);
+
+                auto& segment = loudness[(size_t) k];
+                segmentInput.clearMeasurements();
+                segmentOutput.clearMeasurements();
+                segmentInput.setStepLog (&segment.inputSteps);
+                segmentOutput.setStepLog (&segment.outputSteps);
+
+                measure (start, end - start);
+                segment.inputPeak = segmentInput.getTruePeakGain();
+                segment.outputPeak = segmentOutput.getTruePeakGain();
+            }
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait (-1);
+
+    double measured = 0.0;
+
+    for (int k = 0; k < numSegments - 1; ++k)
+    {
+        const auto end = (k + 1) * segmentLength;
+        const auto& seam = seamChecks[(size_t) k];
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < seam.getNumSamples(); ++i)
+                measured = juce::jmax (measured, (double) std::abs (seam.getSample (ch, i) - output.getSample (ch, end + i)));
+    }
+
+    report.measuredSeamError = measured;
+
+    // Should never trip, but if the stitched render is worse than promised the
+    // caller gets a serial render instead of a silently wrong one.
+    if (measured > options.maxSegmentError * juce::jmax (1.0e-3, (double) peak))
+        return false;
+
+    for (const auto& segment : loudness)
+    {
+        for (auto meanSquare : segment.inputSteps)
+            inputMeter->addStep (meanSquare);
+
+        for (auto meanSquare : segment.outputSteps)
+            outputMeter->addStep (meanSquare);
+
+        inputMeter->addTruePeak (segment.inputPeak);
+        outputMeter->addTruePeak (segment.outputPeak);
+    }
+
+    return true;
+}
+
+//==============================================================================
+int OfflineRenderer::getPreRollLength (const ChainCoefficients& chain, double sampleRate, double tolerance, double& tailSum)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+
+    // Measured in double with no anti-denormal offset, so the response keeps
+    // decaying instead of settling on the offset's tiny DC level.
+    std::array<double, ChainCoefficients::maxSections> s1 {}, s2 {};
+    std::vector<float> magnitudes;
+
+    // Blocks of at least 100 ms, so a slow 20 Hz ring can't look finished
+    // just because one block happens to sit near a zero crossing.
+    const auto blockSize = juce::jmax (1024, (int) (sampleRate * 0.1));
+    const auto maxLength = (int) (sampleRate * 60.0);
+    double total = 0.0, blockSum = 0.0;
+
+    for (int n = 0; n < maxLength; ++n)
+    {
+        auto x = n == 0 ? 1.0 : 0.0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            const auto& c = sections[(size_t) i];
+            const auto y = c.b0 * x + s1[(size_t) i];
+            s1[(size_t) i] = c.b1 * x - c.a1 * y + s2[(size_t) i];
+            s2[(size_t) i] = c.b2 * x - c.a2 * y;
+            x = y;
+        }
+
+        magnitudes.push_back ((float) std::abs (x));
+        total += std::abs (x);
+        blockSum += std::abs (x);
+
+        if ((n + 1) % blockSize == 0)
+        {
+            if (blockSum <= total * 1.0e-16)
+                break;
+
+            blockSum = 0.0;
+        }
+    }
+
+    auto length = (int) magnitudes.size();
+    tailSum = 0.0;
+
+    while (length > 0 && tailSum + magnitudes[(size_t) length - 1] <= tolerance)
+        tailSum += magnitudes[(size_t) --length];
+
+    return length;
+}
+
+//==============================================================================
+static int chooseBitDepth (juce::AudioFormat& format, int preferred)
+{
+    auto depths = format.getPossibleBitDepths();
+
+    if (depths.contains (preferred))
+        return preferred;
+
+    return depths.contains (24) ? 24 : depths.getLast();
+}
+
+static std::unique_ptr<juce::AudioFormatReader> createReader (juce::AudioFormatManager& formats, const juce::File& file, bool useMemoryMapping)
+{
+    // Uncompressed input is read straight out of the page cache, skipping
+    // the read() syscalls and intermediate buffer of a FileInputStream.
+    if (useMemoryMapping)
+    {
+        if (auto* format = formats.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+
+            if (mapped != nullptr && mapped->mapEntireFile())
+                return mapped;
+        }
+    }
+
+    return std::unique_ptr<juce::AudioFormatReader> (formats.createReaderFor (file));
+}
+
+static std::unique_ptr<juce::AudioFormatWriter> createWriter (juce::AudioFormatManager& formats, const juce::File& file,
+                                                              const juce::AudioFormatReader& source, juce::String& error)
+{
+    auto* format = formats.findFormatForFileExtension (file.getFileExtension());
+
+    if (format == nullptr)
+    {
+        error = "No audio format matches " + file.getFileName();
+        return {};
+    }
+
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+
+    if (stream == nullptr)
+    {
+        error = "Couldn't write " + file.getFullPathName();
+        return {};
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), source.sampleRate, source.numChannels,
+                                                                              chooseBitDepth (*format, (int) source.bitsPerSample),
+                                                                              {}, 0));
+
+    if (writer == nullptr)
+    {
+        error = format->getFormatName() + " can't write this channel count or sample rate";
+        return {};
+    }
+
+    stream.release();
+    return writer;
+}
+
+juce::String OfflineRenderer::renderFile (const juce::File& input, const juce::File& output,
+                                          const Options& options, Report& report) const
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    auto reader = createReader (formats, input, options.useMemoryMapping);
+
+    if (reader == nullptr)
+        return "Couldn't read " + input.getFullPathName();
+
+    juce::String error;
+    auto writer = createWriter (formats, output, *reader, error);
+
+    if (writer == nullptr)
+        return error;
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto length = reader->lengthInSamples;
+
+    if (options.splitIntoSegments && ! options.deterministic)
+    {
+        if (length > std::numeric_limits<int>::max())
+            return input.getFileName() + " is too long to render in segments";
+
+        juce::AudioBuffer<float> source (numChannels, (int) length);
+        reader->read (&source, 0, (int) length, 0, true, true);
+
+        juce::AudioBuffer<float> rendered;
+        report = render (source, rendered, reader->sampleRate, options);
+
+        if (! writer->writeFromAudioSampleBuffer (rendered, 0, rendered.getNumSamples()))
+            return "Failed while writing " + output.getFullPathName();
+    }
+    else
+    {
+        report = {};
+        juce::int64 position = 0;
+
+        const auto failedStage = renderStream (numChannels, reader->sampleRate, 1 << 16, options, report,
+            [&] (juce::AudioBuffer<float>& chunk)
+            {
+                const auto numSamples = (int) juce::jmin ((juce::int64) chunk.getNumSamples(), length - position);
+
+                if (numSamples <= 0)
+                    return 0;
+
+                // This read() returns nothing and fills whatever it can't
+                // decode with silence; numSamples is kept inside
+                // lengthInSamples, so every sample asked for is in the file.
+                reader->read (&chunk, 0, numSamples, position, true, true);
+                position += numSamples;
+                return numSamples;
+            },
+            [&] (const juce::AudioBuffer<float>& chunk, int numSamples)
+            {
+                return writer->writeFromAudioSampleBuffer (chunk, 0, numSamples);
+            });
+
+        if (failedStage == "encode")
+            return "Failed while writing " + output.getFullPathName();
+    }
+
+    report.memoryMapped = dynamic_cast<juce::MemoryMappedAudioFormatReader*> (reader.get()) != nullptr;
+    report.bytesProcessed = input.getSize();
+    report.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    return {};
+}
+
+juce::String OfflineRenderer::renderRaw (const RawPcm::Format& format, int inputFd, int outputFd,
+                                         const Options& options, Report& report) const
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    if (format.numChannels <= 0 || format.sampleRate <= 0.0)
+        return "Raw input needs a channel count and sample rate";
+
+    // Small enough for a chunk's samples to stay in cache between stages,
+    // and to keep the latency of a pipeline down.
+    constexpr int chunkSize = 1 << 14;
+
+    report = {};
+    RawPcm::Input reader (inputFd, format, chunkSize);
+    RawPcm::Output writer (outputFd, format, chunkSize, options.zeroCopyOutput);
+
+    const auto failedStage = renderStream (format.numChannels, format.sampleRate, chunkSize, options, report,
+                                           [&] (juce::AudioBuffer<float>& chunk)   { return reader.read (chunk); },
+                                           [&] (const juce::AudioBuffer<float>& chunk, int numSamples)   { return writer.write (chunk, numSamples); });
+
+    if (failedStage == "decode")
+        return "Failed while reading the input";
+
+    if (failedStage == "encode")
+        return "Failed while writing the output";
+
+    if (reader.getNumLeftoverBytes() > 0)
+        return "The input ended partway through a frame; its last " + juce::String (reader.getNumLeftoverBytes()) + " bytes were dropped";
+
+    report.zeroCopyOutput = writer.isZeroCopy();
+    report.bytesProcessed = reader.getNumBytesRead();
+    report.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    return {};
+}
+
+juce::String OfflineRenderer::renderStream (int numChannels, double sampleRate, int chunkSize, const Options& options, Report& report,
+                                            std::function<int (juce::AudioBuffer<float>&)> decode,
+                                            std::function<bool (const juce::AudioBuffer<float>&, int)> encode) const
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    const auto chain = design (sampleRate, options);
+    Determinism::AudioHash hash;
+
+    ParallelCoefficients parallelCoefficients;
+    const auto* parallel = designParallel (chain, sampleRate, options, parallelCoefficients, report) ? &parallelCoefficients : nullptr;
+
+    std::vector<Cascade> cascades ((size_t) (options.deterministic ? numChannels : 0));
+    std::vector<ChannelFilter> filters;
+
+    for (auto& cascade : cascades)
+        cascade.setCoefficients (chain);
+
+    for (int ch = 0; ch < numChannels && ! options.deterministic; ++ch)
+        filters.emplace_back (chain, parallel);
+
+    // Metered in the same pass as the filtering, so the stats cost no
+    // second read of the input.
+    LoudnessMeter inputMeter, outputMeter;
+
+    if (options.measureLoudness)
+    {
+        inputMeter.prepare (sampleRate, numChannels, chunkSize, true, options.deterministic);
+        outputMeter.prepare (sampleRate, numChannels, chunkSize, true, options.deterministic);
+    }
+
+    RenderPipeline::Stages stages;
+    stages.decode = std::move (decode);
+    stages.encode = std::move (encode);
+
+    stages.process = [&] (juce::AudioBuffer<float>& chunk, int numSamples)
+    {
+        if (options.measureLoudness)
+            inputMeter.process (chunk.getArrayOfReadPointers(), numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = chunk.getWritePointer (ch);
+
+            if (options.deterministic)
+                Determinism::flushDenormals (samples, numSamples);
+
+            if (options.deterministic)
+                cascades[(size_t) ch].process (samples, numSamples);
+            else
+                filters[(size_t) ch].process (samples, numSamples);
+
+            if (options.deterministic)
+                Determinism::flushDenormals (samples, numSamples);
+        }
+
+        if (options.deterministic)
+            hash.add (chunk.getArrayOfReadPointers(), numChannels, numSamples);
+
+        if (options.measureLoudness)
+            outputMeter.process (chunk.getArrayOfReadPointers(), numSamples);
+    };
+
+    const auto pipeline = RenderPipeline (numChannels, chunkSize).run (stages);
+
+    if (pipeline.failedStage.isEmpty() && options.deterministic)
+        report.outputHash = hash.toString();
+
+    report.decodeUtilisation = pipeline.decodeUtilisation;
+    report.filterUtilisation = pipeline.processUtilisation;
+    report.encodeUtilisation = pipeline.encodeUtilisation;
+    report.bottleneck = pipeline.getBottleneck();
+
+    if (options.measureLoudness)
+    {
+        report.inputLoudness = inputMeter.getReadings();
+        report.outputLoudness = outputMeter.getReadings();
+    }
+
+    return pipeline.failedStage;
+}
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+
+    Renders audio through the Vonic EQ without a host. Long material can be
+    cut into segments that are filtered in parallel: each segment starts
+    early by enough pre-roll for the IIR tails to have died away, so the
+    stitched result matches a straight serial render to within a bound that
+    is both computed up front and checked afterwards.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+#include "LoudnessMeter.h"
+
+struct ParallelCoefficients;
+namespace RawPcm { struct Format; }
+
+class OfflineRenderer
+{
+public:
+    struct Options
+    {
+        bool splitIntoSegments = false;
+        int numThreads = juce::SystemStats::getNumCpus();
+
+        /** Length of each segment, not counting its pre-roll. */
+        double segmentSeconds = 30.0;
+
+        /** Largest difference from a serial render that segmenting may cause,
+            relative to the input's peak level (1.0e-6 is -120 dB).
+        */
+        double maxSegmentError = 1.0e-6;
+
+        /** Read WAV/AIFF input through a memory map rather than buffered reads. */
+        bool useMemoryMapping = true;
+
+        /** Bit-identical output on any machine (see Determinism.h). Always
+            renders serially, and fills in Report::outputHash.
+        */
+        bool deterministic = false;
+
+        /** Runs each channel in parallel form (see ParallelForm.h) when the
+            design is accurate enough, otherwise as usual. Ignored by
+            deterministic renders.
+        */
+        bool useParallelForm = false;
+
+        /** Send renderRaw()'s output through vmsplice() when it goes to a
+            pipe (see RawPcm.h).
+        */
+        bool zeroCopyOutput = false;
+
+        /** Measure BS.1770 loudness and true peak of the input and output,
+            on the way through (see LoudnessMeter.h).
+        */
+        bool measureLoudness = false;
+    };
+
+    struct Report
+    {
+        int numSegments = 1;
+        int preRollSamples = 0;
+
+        /** Worst-case seam error from the impulse response tail, absolute. */
+        double errorBound = 0.0;
+
+        /** Largest seam error actually seen when stitching, absolute. */
+        double measuredSeamError = 0.0;
+
+        double renderSeconds = 0.0;
+
+        /** Set by renderFile(). */
+        bool memoryMapped = false;
+
+        /** Set by renderFile() and renderRaw(). */
+        juce::int64 bytesProcessed = 0;
+
+        /** Hash of the rendered samples, set for deterministic renders. */
+        juce::String outputHash;
+
+        /** Whether the parallel form was used, and its estimated error (set
+            whenever it was asked for).
+        */
+        bool parallelForm = false;
+        double parallelErrorDb = 0.0;
+
+        /** Set by renderRaw(): whether the output went out through vmsplice(). */
+        bool zeroCopyOutput = false;
+
+        /** Set by renderFile() when it streams, and by renderRaw(): how busy
+            its decode, filter and encode threads were, 1 being all the
+            time, and which of them the others were waiting on.
+        */
+        double decodeUtilisation = 0.0, filterUtilisation = 0.0, encodeUtilisation = 0.0;
+        juce::String bottleneck;
+
+        /** Set when Options::measureLoudness is. */
+        LoudnessMeter::Readings inputLoudness, outputLoudness;
+    };
+
+    explicit OfflineRenderer (const FilterSet& settings);
+
+    /** Filters every channel of input into output, which is resized to match. */
+    Report render (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                   double sampleRate, const Options& options) const;
+
+    /** Renders a file into another in the format that matches the output's
+        extension, returning an error message on failure.
+
+        Serial renders stream through the file in chunks, decoding, filtering
+        and encoding on three threads at once (see RenderPipeline.h);
+        segmented renders need the whole file in memory. renderSeconds then
+        covers reading and writing as well.
+    */
+    juce::String renderFile (const juce::File& input, const juce::File& output, const Options& options, Report& report) const;
+
+    /** Filters raw interleaved PCM from one file descriptor to the other
+        until the input ends, returning an error message on failure. Streams
+        the same way as a serial renderFile(); segments aren't possible
+        without the whole input.
+    */
+    juce::String renderRaw (const RawPcm::Format& format, int inputFd, int outputFd, const Options& options, Report& report) const;
+
+    /** Shortest pre-roll after which the rest of the chain's impulse response
+        sums (L1) to no more than tolerance; tailSum receives that remainder.
+    */
+    static int getPreRollLength (const ChainCoefficients& chain, double sampleRate, double tolerance, double& tailSum);
+
+private:
+    ChainCoefficients design (double sampleRate, const Options& options) const;
+    void renderSerial (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                       const ChainCoefficients& chain, const ParallelCoefficients* parallel, bool deterministic,
+                       LoudnessMeter* inputMeter, LoudnessMeter* outputMeter) const;
+    juce::String renderStream (int numChannels, double sampleRate, int chunkSize, const Options& options, Report& report,
+                               std::function<int (juce::AudioBuffer<float>&)> decode,
+                               std::function<bool (const juce::AudioBuffer<float>&, int)> encode) const;
+    bool renderSegmented (const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                          const ChainCoefficients& chain, const ParallelCoefficients* parallel, double sampleRate,
+                          const Options& options, Report& report,
+                          LoudnessMeter* inputMeter, LoudnessMeter* outputMeter) const;
+
+    FilterSet settings;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    ParallelForm.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelForm.h"
+#include "ChainResponse.h"
+
+namespace ParallelForm
+{
+
+using Complex = std::complex<double>;
+
+// Response of one parallel section, in double from its float coefficients.
+static Complex getSectionResponse (const ParallelCoefficients::Section& s, Complex z1)
+{
+    return ((double) s.b0 + (double) s.b1 * z1) / (1.0 + (double) s.a1 * z1 + (double) s.a2 * z1 * z1);
+}
+
+bool design (const ChainCoefficients& chain, double sampleRate, ParallelCoefficients& parallel)
+{
+    std::array<SectionCoefficients, ChainCoefficients::maxSections> sections;
+    const auto numSections = getActiveSections (chain, sections);
+
+    // Section k's denominator is (1 - p[2k] z^-1) (1 - p[2k + 1] z^-1), or
+    // just (1 - p[2k] z^-1) for a first-order section, which has b2 = a2 = 0.
+    std::array<Complex, 2 * ChainCoefficients::maxSections> poles;
+    std::array<bool, ChainCoefficients::maxSections> isFirstOrder {};
+    int numPoles = 0;
+    double direct = 1.0;
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto& c = sections[(size_t) k];
+        isFirstOrder[(size_t) k] = c.a2 == 0.f && c.b2 == 0.f;
+
+        // The numerator and denominator have the same degree, so what's left
+        // over is the ratio of their highest coefficients.
+        const auto highestA = isFirstOrder[(size_t) k] ? (double) c.a1 : (double) c.a2;
+        const auto highestB = isFirstOrder[(size_t) k] ? (double) c.b1 : (double) c.b2;
+
+        // A pole at the origin would need a longer FIR part than this has.
+        if (std::abs (highestA) < 1.0e-12)
+            return false;
+
+        direct *= highestB / highestA;
+
+        if (isFirstOrder[(size_t) k])
+        {
+            poles[(size_t) numPoles++] = -(double) c.a1;
+            continue;
+        }
+
+        const auto root = std::sqrt (Complex ((double) c.a1 * c.a1 - 4.0 * c.a2));
+        poles[(size_t) numPoles++] = (-(double) c.a1 + root) * 0.5;
+        poles[(size_t) numPoles++] = (-(double) c.a1 - root) * 0.5;
+    }
+
+    // Residue of each pole: (1 - p z^-1) H(z), evaluated at z = p.
+    std::array<Complex, 2 * ChainCoefficients::maxSections> residues;
+
+    for (int i = 0; i < numPoles; ++i)
+    {
+        const auto w = 1.0 / poles[(size_t) i];
+        Complex residue = 1.0;
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto& c = sections[(size_t) k];
+            residue *= (double) c.b0 + (double) c.b1 * w + (double) c.b2 * w * w;
+        }
+
+        for (int j = 0; j < numPoles; ++j)
+            if (j != i)
+                residue /= 1.0 - poles[(size_t) j] * w;
+
+        if (! (std::isfinite (residue.real()) && std::isfinite (residue.imag())))
+            return false;
+
+        residues[(size_t) i] = residue;
+    }
+
+    // Both poles of a cascade section go back into one parallel section:
+    // r1 / (1 - p1 z^-1) + r2 / (1 - p2 z^-1), over the same denominator.
+    std::array<ParallelCoefficients::Section, ChainCoefficients::maxSections> candidates;
+
+    for (int k = 0, pole = 0; k < numSections; ++k)
+    {
+        auto& candidate = candidates[(size_t) k];
+        candidate.a1 = sections[(size_t) k].a1;
+        candidate.a2 = sections[(size_t) k].a2;
+
+        if (isFirstOrder[(size_t) k])
+        {
+            candidate.b0 = (float) residues[(size_t) pole++].real();
+            continue;
+        }
+
+        const auto r1 = residues[(size_t) pole], r2 = residues[(size_t) pole + 1];
+        const auto p1 = poles[(size_t) pole], p2 = poles[(size_t) pole + 1];
+        pole += 2;
+
+        candidate.b0 = (float) (r1 + r2).real();
+        candidate.b1 = (float) -(r1 * p2 + r2 * p1).real();
+    }
+
+    // Compare with the cascade on a log grid. Each section's own peak also
+    // goes towards the rounding noise, which the sum carries at roughly float
+    // epsilon times the size of the terms being added.
+    constexpr int numPoints = 512;
+    const auto frequencies = ChainResponse::makeLogFrequencies (numPoints, sampleRate);
+    std::vector<Complex> cascade ((size_t) numPoints);
+    ChainResponse::getFrequencyResponse (chain, sampleRate, frequencies.data(), cascade.data(), numPoints);
+
+    std::array<double, ChainCoefficients::maxSections> sectionPeaks {};
+    double peak = 0.0, maxDifference = 0.0;
+
+    for (int n = 0; n < numPoints; ++n)
+    {
+        const auto z1 = std::polar (1.0, -juce::MathConstants<double>::twoPi * frequencies[(size_t) n] / sampleRate);
+        Complex sum = (double) (float) direct;
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto response = getSectionResponse (candidates[(size_t) k], z1);
+            sectionPeaks[(size_t) k] = juce::jmax (sectionPeaks[(size_t) k], std::abs (response));
+            sum += response;
+        }
+
+        peak = juce::jmax (peak, std::abs (cascade[(size_t) n]));
+        maxDifference = juce::jmax (maxDifference, std::abs (sum - cascade[(size_t) n]));
+    }
+
+    parallel = {};
+    parallel.direct = (float) direct;
+    auto noise = std::abs (direct);
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        noise += sectionPeaks[(size_t) k];
+
+        // Sections whose poles the numerator cancels (a flat peak) add nothing.
+        if (sectionPeaks[(size_t) k] > peak * 1.0e-9)
+            parallel.sections[(size_t) parallel.numSections++] = candidates[(size_t) k];
+    }
+
+    noise *= std::numeric_limits<float>::epsilon();
+    parallel.errorDb = juce::Decibels::gainToDecibels ((maxDifference + noise) / juce::jmax (1.0e-12, peak), -400.0);
+
+    return parallel.errorDb <= errorBoundDb;
+}
+
+}
+
+//==============================================================================
+void ParallelChain::setCoefficients (const ParallelCoefficients& parallel) noexcept
+{
+    direct = parallel.direct;
+    numGroups = (parallel.numSections + numLanes - 1) / numLanes;
+
+    // Spare lanes in the last group get all-zero coefficients, so they only
+    // ever output the anti-denormal offset.
+    alignas (sizeof (Register)) float lanes[4][numLanes];
+
+    for (int g = 0; g < numGroups; ++g)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto index = g * numLanes + lane;
+            const auto section = index < parallel.numSections ? parallel.sections[(size_t) index] : ParallelCoefficients::Section();
+
+            // Stored negated, so the update is all adds.
+            lanes[0][lane] = section.b0;
+            lanes[1][lane] = section.b1;
+            lanes[2][lane] = -section.a1;
+            lanes[3][lane] = -section.a2;
+        }
+
+        b0[g] = Register::fromRawArray (lanes[0]);
+        b1[g] = Register::fromRawArray (lanes[1]);
+        a1[g] = Register::fromRawArray (lanes[2]);
+        a2[g] = Register::fromRawArray (lanes[3]);
+    }
+}
+
+void ParallelChain::reset() noexcept
+{
+    for (int g = 0; g < maxGroups; ++g)
+        s1[g] = s2[g] = Register::expand (0.0f);
+}
+
+template <int NumGroups>
+void ParallelChain::processGroups (float* samples, int numSamples) noexcept
+{
+    Register lb0[NumGroups], lb1[NumGroups], la1[NumGroups], la2[NumGroups], ls1[NumGroups], ls2[NumGroups];
+
+    for (int g = 0; g < NumGroups; ++g)
+    {
+        lb0[g] = b0[g];  lb1[g] = b1[g];  la1[g] = a1[g];  la2[g] = a2[g];
+        ls1[g] = s1[g];  ls2[g] = s2[g];
+    }
+
+    const auto offset = Register::expand (Biquad::antiDenormal);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = Register::expand (samples[i]);
+        auto total = lb0[0] * x + ls1[0];
+
+        ls1[0] = lb1[0] * x + la1[0] * total + ls2[0] + offset;
+        ls2[0] = la2[0] * total;
+
+        for (int g = 1; g < NumGroups; ++g)
+        {
+            const auto y = lb0[g] * x + ls1[g];
+            ls1[g] = lb1[g] * x + la1[g] * y + ls2[g] + offset;
+            ls2[g] = la2[g] * y;
+            total += y;
+        }
+
+        samples[i] = direct * samples[i] + total.sum();
+    }
+
+    // As with Biquad, a blown-up state drops the block and starts again.
+    auto check = Register::expand (0.0f);
+
+    for (int g = 0; g < NumGroups; ++g)
+        check += ls1[g] + ls2[g];
+
+    if (! std::isfinite (check.sum()))
+    {
+        juce::FloatVectorOperations::clear (samples, numSamples);
+
+        for (int g = 0; g < NumGroups; ++g)
+            ls1[g] = ls2[g] = Register::expand (0.0f);
+    }
+
+    for (int g = 0; g < NumGroups; ++g)
+    {
+        s1[g] = ls1[g];
+        s2[g] = ls2[g];
+    }
+}
+
+void ParallelChain::process (float* samples, int numSamples) noexcept
+{
+    switch (numGroups)
+    {
+        case 0:  juce::FloatVectorOperations::multiply (samples, direct, numSamples); break;
+        case 1:  processGroups<1> (samples, numSamples); break;
+        case 2:  processGroups<2> (samples, numSamples); break;
+        case 3:  processGroups<3> (samples, numSamples); break;
+        case 4:  processGroups<4> (samples, numSamples); break;
+        case 5:  processGroups<5> (samples, numSamples); break;
+        default: jassertfalse; break;
+    }
+}
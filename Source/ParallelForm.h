@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    ParallelForm.h
+
+    The whole EQ as a sum instead of a chain: by partial fractions, the
+    product of the cascade's sections is rewritten as a constant plus one
+    two-pole section per cascade section, every one of them fed the same
+    input. The poles are just each cascade section's own, so the parallel
+    sections share its denominators; only the numerators are new.
+
+    With no section waiting on another, they run four to a SIMDRegister on
+    a single channel, one sample at a time.
+
+    Partial fractions go wrong when poles sit close together (a low cut and
+    a high cut near the same frequency, say): the residues grow huge and
+    cancel each other out, leaving float rounding behind. Each design is
+    checked for that, and rejected in favour of the cascade if it is off by
+    more than errorBoundDb.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+struct ParallelCoefficients
+{
+    /** b0 + b1 z^-1 over 1 + a1 z^-1 + a2 z^-2. */
+    struct Section
+    {
+        float b0 = 0.f, b1 = 0.f, a1 = 0.f, a2 = 0.f;
+    };
+
+    float direct = 0.f;
+    std::array<Section, ChainCoefficients::maxSections> sections;
+    int numSections = 0;
+
+    /** Estimated error against the cascade, relative to its peak gain: the
+        response difference plus the rounding noise the sum would add.
+    */
+    double errorDb = 0.0;
+};
+
+namespace ParallelForm
+{
+    static constexpr double errorBoundDb = -75.0;
+
+    /** Fills parallel with the parallel form of chain, returning false if
+        that can't be done to within errorBoundDb.
+    */
+    bool design (const ChainCoefficients& chain, double sampleRate, ParallelCoefficients& parallel);
+}
+
+//==============================================================================
+/** One channel of the EQ in parallel form. */
+class ParallelChain
+{
+public:
+    ParallelChain() noexcept   { reset(); }
+
+    void setCoefficients (const ParallelCoefficients& parallel) noexcept;
+    void reset() noexcept;
+    void process (float* samples, int numSamples) noexcept;
+
+private:
+    using Register = juce::dsp::SIMDRegister<float>;
+    static constexpr int numLanes = (int) Register::SIMDNumElements;
+    static constexpr int maxGroups = (ChainCoefficients::maxSections + numLanes - 1) / numLanes;
+
+    template <int NumGroups>
+    void processGroups (float* samples, int numSamples) noexcept;
+
+    float direct = 0.f;
+    Register b0[maxGroups], b1[maxGroups], a1[maxGroups], a2[maxGroups];
+    Register s1[maxGroups], s2[maxGroups];
+    int numGroups = 0;
+};
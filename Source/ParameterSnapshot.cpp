@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+#include "PluginProcessor.h"
+
+#if JUCE_LINUX
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+// In Field order. Note that the "HighPass" parameter is the low cut.
+const std::array<const char*, ParameterSnapshot::numFields> ParameterSnapshot::parameterIDs
+    { "HighPass", "LowPass", "Peak", "Gain", "Quality", "HighPassSlope", "LowPassSlope" };
+
+ParameterSnapshot::ParameterSnapshot (juce::AudioProcessorValueTreeState& s)
+    : state (s)
+{
+    for (size_t i = 0; i < parameterIDs.size(); ++i)
+    {
+        sources[i] = state.getRawParameterValue (parameterIDs[i]);
+        jassert (sources[i] != nullptr);
+        state.addParameterListener (parameterIDs[i], this);
+    }
+
+    publish();
+}
+
+ParameterSnapshot::~ParameterSnapshot()
+{
+    for (auto* parameterID : parameterIDs)
+        state.removeParameterListener (parameterID, this);
+}
+
+void ParameterSnapshot::parameterChanged (const juce::String&, float)
+{
+    // The raw value has already been stored by the time listeners hear of
+    // it, so republishing everything from the sources picks it up.
+    publish();
+}
+
+void ParameterSnapshot::publish() noexcept
+{
+    // The flag and sequence stay sequentially consistent between writers,
+    // so a writer that gives up can't slip past the final check below.
+    pending = true;
+
+    while (pending)
+    {
+        auto current = sequence.load();
+
+        // Odd means someone else is publishing, and they'll see our flag
+        // before they finish.
+        if ((current & 1) != 0 || ! sequence.compare_exchange_strong (current, current + 1))
+            return;
+
+        std::atomic_thread_fence (std::memory_order_release);
+
+        while (pending.exchange (false))
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i].store (sources[i]->load (std::memory_order_relaxed), std::memory_order_relaxed);
+
+        sequence = current + 2;
+    }
+
+    wake();
+}
+
+void ParameterSnapshot::wake() noexcept
+{
+    ++changeCount;
+
+    // A waiter that isn't counted yet will see the new count when it looks
+    // again after counting itself, so skipping the system call is safe.
+   #if JUCE_LINUX
+    if (numWaiters.load() > 0)
+        syscall (SYS_futex, reinterpret_cast<juce::uint32*> (&changeCount), FUTEX_WAKE_PRIVATE, std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+   #endif
+}
+
+void ParameterSnapshot::waitForChange (juce::uint32 count, int timeoutMs) const noexcept
+{
+    const auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+
+    // Counted before the first look at the count, which wake() relies on.
+    ++numWaiters;
+
+    while (changeCount.load() == count)
+    {
+        const auto remainingMs = timeoutMs < 0 ? 1.0e9 : deadline - juce::Time::getMillisecondCounterHiRes();
+
+        if (remainingMs <= 0.0)
+            break;
+
+       #if JUCE_LINUX
+        // Returns at once if the count has moved on since the load above.
+        timespec timeout { (time_t) (remainingMs / 1000.0), (long) (std::fmod (remainingMs, 1000.0) * 1.0e6) };
+        syscall (SYS_futex, reinterpret_cast<const juce::uint32*> (&changeCount), FUTEX_WAIT_PRIVATE, count,
+                 timeoutMs < 0 ? nullptr : &timeout, nullptr, 0);
+       #else
+        std::this_thread::sleep_for (std::chrono::microseconds ((juce::int64) juce::jmin (1000.0, remainingMs * 1000.0)));
+       #endif
+    }
+
+    --numWaiters;
+}
+
+bool ParameterSnapshot::tryRead (FilterSet& settings, juce::uint32* version) const noexcept
+{
+    const auto before = sequence.load (std::memory_order_acquire);
+
+    if ((before & 1) != 0)
+        return false;
+
+    std::array<float, numFields> copy;
+
+    for (size_t i = 0; i < copy.size(); ++i)
+        copy[i] = values[i].load (std::memory_order_relaxed);
+
+    std::atomic_thread_fence (std::memory_order_acquire);
+
+    if (sequence.load (std::memory_order_relaxed) != before)
+        return false;
+
+    settings.lowCutFreq = copy[lowCutFreq];
+    settings.highCutFreq = copy[highCutFreq];
+    settings.peakFreq = copy[peakFreq];
+    settings.peakGain = copy[peakGain];
+    settings.peakQual = copy[peakQual];
+    settings.lowCutSlope = static_cast<Gradient> ((int) copy[lowCutSlope]);
+    settings.highCutSlope = static_cast<Gradient> ((int) copy[highCutSlope]);
+
+    if (version != nullptr)
+        *version = before;
+
+    return true;
+}
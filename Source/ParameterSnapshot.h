@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+
+    The EQ's parameters as one FilterSet that the audio thread can read
+    without looking anything up by name. The parameters' value pointers are
+    resolved once, and a seqlock republishes all seven values together
+    whenever any of them changes, so a read never sees half of an update.
+
+    Writers are whichever threads change parameters (the host's automation,
+    the editor). They combine rather than wait: one that finds another
+    mid-publish leaves a flag, and the one publishing goes round again.
+
+    A thread can sleep until the next publish with waitForChange(). That
+    is a futex on Linux, which publish() only makes a system call to wake
+    when someone is waiting; elsewhere the waiter looks every millisecond.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+class ParameterSnapshot  : private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    explicit ParameterSnapshot (juce::AudioProcessorValueTreeState& state);
+    ~ParameterSnapshot() override;
+
+    /** Copies out the latest settings and returns true, or returns false
+        without waiting if a writer is halfway through publishing them.
+        Wait-free and safe on the audio thread.
+
+        If version is given it receives a number that goes up with every
+        publish, so that reads can be put in order.
+    */
+    bool tryRead (FilterSet& settings, juce::uint32* version = nullptr) const noexcept;
+
+    /** The version the next successful tryRead() will report, or later. */
+    juce::uint32 getVersion() const noexcept   { return sequence.load (std::memory_order_acquire) & ~1u; }
+
+    /** Goes up with every publish and every wake(). Take it before looking
+        at the settings, then pass it to waitForChange().
+    */
+    juce::uint32 getChangeCount() const noexcept   { return changeCount.load(); }
+
+    /** Sleeps until the change count moves on from count, or for up to
+        timeoutMs (-1 for no limit), so that a thread can wait for a change
+        instead of polling. Not for the audio thread.
+    */
+    void waitForChange (juce::uint32 count, int timeoutMs) const noexcept;
+
+    /** Ends any waitForChange() as a publish would, e.g. to stop the thread
+        waiting. Takes no locks, so publish() can call it on the audio thread.
+    */
+    void wake() noexcept;
+
+private:
+    enum Field { lowCutFreq, highCutFreq, peakFreq, peakGain, peakQual, lowCutSlope, highCutSlope, numFields };
+
+    static const std::array<const char*, numFields> parameterIDs;
+
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void publish() noexcept;
+
+    juce::AudioProcessorValueTreeState& state;
+    std::array<std::atomic<float>*, numFields> sources {};
+
+    std::atomic<juce::uint32> sequence { 0 };
+    std::atomic<bool> pending { false };
+    std::array<std::atomic<float>, numFields> values {};
+
+    // Both seq_cst, so a waiter about to sleep and a wake() can't miss
+    // each other, the same way as in WorkerPool.
+    std::atomic<juce::uint32> changeCount { 0 };
+    mutable std::atomic<juce::uint32> numWaiters { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterSnapshot)
+};
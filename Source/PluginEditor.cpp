@@ -1,41 +1,165 @@
-
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-VonicRewriteAudioProcessorEditor::VonicRewriteAudioProcessorEditor (VonicRewriteAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
-{
-    // Make sure that before the constructor has finished, you've set the
-    // editor's size to whatever you need it to be.
-    setSize (400, 300);
-}
-
-VonicRewriteAudioProcessorEditor::~VonicRewriteAudioProcessorEditor()
-{
-}
-
-//==============================================================================
-void VonicRewriteAudioProcessorEditor::paint (juce::Graphics& g)
-{
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
-}
-
-void VonicRewriteAudioProcessorEditor::resized()
-{
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
-}
+
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+VonicRewriteAudioProcessorEditor::VonicRewriteAudioProcessorEditor (VonicRewriteAudioProcessor& p)
+    : AudioProcessorEditor (&p), audioProcessor (p)
+{
+    addAndMakeVisible (parameters);
+
+    matchButton.onClick = [this] { chooseMatchFiles(); };
+    addAndMakeVisible (matchButton);
+
+    loudnessLabel.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    loudnessLabel.setJustificationType (juce::Justification::centredLeft);
+    addAndMakeVisible (loudnessLabel);
+
+    resetLoudnessButton.onClick = [this] { audioProcessor.resetLoudness(); };
+    addAndMakeVisible (resetLoudnessButton);
+
+    qualityLabel.setColour (juce::Label::textColourId, juce::Colours::orange);
+    qualityLabel.setJustificationType (juce::Justification::centredRight);
+    addChildComponent (qualityLabel);
+
+   #if VONIC_TELEMETRY
+    telemetryLabel.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    telemetryLabel.setJustificationType (juce::Justification::centredLeft);
+    addAndMakeVisible (telemetryLabel);
+
+    lastSnapshot = audioProcessor.getTelemetry().getSnapshot();
+   #endif
+
+    audioProcessor.setMeteringEnabled (true);
+    startTimerHz (4);
+
+    // Make sure that before the constructor has finished, you've set the
+    // editor's size to whatever you need it to be.
+    setSize (juce::jmax (400, parameters.getWidth()), parameters.getHeight() + loudnessHeight + toolbarHeight + telemetryHeight);
+}
+
+VonicRewriteAudioProcessorEditor::~VonicRewriteAudioProcessorEditor()
+{
+    audioProcessor.setMeteringEnabled (false);
+}
+
+//==============================================================================
+void VonicRewriteAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+}
+
+void VonicRewriteAudioProcessorEditor::resized()
+{
+    auto bounds = getLocalBounds();
+    auto toolbar = bounds.removeFromBottom (toolbarHeight).reduced (4);
+    matchButton.setBounds (toolbar.removeFromLeft (100));
+    qualityLabel.setBounds (toolbar.withTrimmedLeft (8));
+
+    auto loudness = bounds.removeFromBottom (loudnessHeight).reduced (4, 2);
+    resetLoudnessButton.setBounds (loudness.removeFromRight (60).reduced (0, 4));
+    loudnessLabel.setBounds (loudness);
+
+   #if VONIC_TELEMETRY
+    telemetryLabel.setBounds (bounds.removeFromBottom (telemetryHeight).reduced (4, 0));
+   #endif
+
+    parameters.setBounds (bounds);
+}
+
+//==============================================================================
+void VonicRewriteAudioProcessorEditor::chooseMatchFiles()
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    const auto wildcard = formats.getWildcardForAllFormats();
+
+    sourceChooser = std::make_unique<juce::FileChooser> ("Choose the track to match", juce::File(), wildcard);
+    sourceChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this, wildcard] (const juce::FileChooser& chooser)
+    {
+        const auto source = chooser.getResult();
+
+        if (source == juce::File())
+            return;
+
+        referenceChooser = std::make_unique<juce::FileChooser> ("Choose one or more references", source.getParentDirectory(), wildcard);
+        referenceChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+                                         | juce::FileBrowserComponent::canSelectMultipleItems,
+                                       [this, source] (const juce::FileChooser& references)
+        {
+            if (! references.getResults().isEmpty())
+                startMatch (source, references.getResults());
+        });
+    });
+}
+
+void VonicRewriteAudioProcessorEditor::startMatch (const juce::File& source, const juce::Array<juce::File>& references)
+{
+    matchButton.setEnabled (false);
+    matchButton.setButtonText ("Matching...");
+
+    // The analysis takes a while on long files, so it runs off the message
+    // thread. If the editor is closed first, the result is simply dropped.
+    juce::Component::SafePointer<VonicRewriteAudioProcessorEditor> editor (this);
+
+    juce::Thread::launch ([editor, source, references]
+    {
+        const auto result = SpectrumMatch::match (source, references, {});
+
+        juce::MessageManager::callAsync ([editor, result]
+        {
+            if (editor != nullptr)
+                editor->matchFinished (result);
+        });
+    });
+}
+
+void VonicRewriteAudioProcessorEditor::matchFinished (const SpectrumMatch::Result& result)
+{
+    matchButton.setEnabled (true);
+    matchButton.setButtonText ("Match...");
+
+    if (result.error.isNotEmpty())
+        juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Couldn't match", result.error);
+    else
+        setFilterSet (audioProcessor.bleh, result.settings);
+}
+
+void VonicRewriteAudioProcessorEditor::timerCallback()
+{
+    const auto level = audioProcessor.getQualityLevel();
+    qualityLabel.setVisible (level != VonicRewriteAudioProcessor::fullQuality);
+
+    if (level != VonicRewriteAudioProcessor::fullQuality)
+    {
+        const auto usage = juce::roundToInt (audioProcessor.getQualityScheduler().getBudgetUsage() * 100.0f);
+        qualityLabel.setText ("Reduced quality (" + juce::String (usage) + "% of budget): "
+                                + VonicRewriteAudioProcessor::getQualityDescription (level),
+                              juce::dontSendNotification);
+    }
+
+    auto loudness = "In   " + audioProcessor.getInputLoudness().toString() + "\n"
+                  + "Out  " + audioProcessor.getOutputLoudness().toString();
+
+    if (const auto gain = audioProcessor.getAutoGainDecibels(); gain != 0.0f)
+        loudness << "  (auto gain " << (gain > 0.0f ? "+" : "") << juce::String (gain, 1) << " dB)";
+
+    loudnessLabel.setText (loudness, juce::dontSendNotification);
+
+   #if VONIC_TELEMETRY
+    const auto snapshot = audioProcessor.getTelemetry().getSnapshot();
+    telemetryLabel.setText (snapshot.toString (lastSnapshot) + "\n" + CoefficientCache::getInstance().getStats().toString(),
+                            juce::dontSendNotification);
+    lastSnapshot = snapshot;
+   #endif
+}
@@ -1,34 +1,69 @@
-
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-
-//==============================================================================
-/**
-*/
-class VonicRewriteAudioProcessorEditor  : public juce::AudioProcessorEditor
-{
-public:
-    VonicRewriteAudioProcessorEditor (VonicRewriteAudioProcessor&);
-    ~VonicRewriteAudioProcessorEditor() override;
-
-    //==============================================================================
-    void paint (juce::Graphics&) override;
-    void resized() override;
-
-private:
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    VonicRewriteAudioProcessor& audioProcessor;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VonicRewriteAudioProcessorEditor)
-};
+
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SpectrumMatch.h"
+
+//==============================================================================
+/**
+*/
+class VonicRewriteAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                           private juce::Timer
+{
+public:
+    VonicRewriteAudioProcessorEditor (VonicRewriteAudioProcessor&);
+    ~VonicRewriteAudioProcessorEditor() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    VonicRewriteAudioProcessor& audioProcessor;
+
+    juce::GenericAudioProcessorEditor parameters { audioProcessor };
+
+    // Auto-EQ: pick a track and some references, and the fitted settings
+    // are written straight into the parameters.
+    void chooseMatchFiles();
+    void startMatch (const juce::File& source, const juce::Array<juce::File>& references);
+    void matchFinished (const SpectrumMatch::Result& result);
+
+    static constexpr int toolbarHeight = 30;
+    juce::TextButton matchButton { "Match..." };
+    std::unique_ptr<juce::FileChooser> sourceChooser, referenceChooser;
+
+    // BS.1770 readings of the main bus in and out, and the button that
+    // starts the integrated loudness and true peak over.
+    static constexpr int loudnessHeight = 36;
+    juce::Label loudnessLabel;
+    juce::TextButton resetLoudnessButton { "Reset" };
+
+    // Says what the processor has given up, while it is short of time.
+    juce::Label qualityLabel;
+    void timerCallback() override;
+
+   #if VONIC_TELEMETRY
+    static constexpr int telemetryHeight = 52;
+   #else
+    static constexpr int telemetryHeight = 0;
+   #endif
+
+   #if VONIC_TELEMETRY
+    juce::Label telemetryLabel;
+    Telemetry::Snapshot lastSnapshot;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VonicRewriteAudioProcessorEditor)
+};
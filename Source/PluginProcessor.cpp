@@ -1,335 +1,886 @@
-
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-VonicRewriteAudioProcessor::VonicRewriteAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-#endif
-{
-}
-
-VonicRewriteAudioProcessor::~VonicRewriteAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String VonicRewriteAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool VonicRewriteAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool VonicRewriteAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool VonicRewriteAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double VonicRewriteAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int VonicRewriteAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int VonicRewriteAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void VonicRewriteAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String VonicRewriteAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void VonicRewriteAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void VonicRewriteAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::dsp::ProcessSpec set;
-    set.maximumBlockSize = samplesPerBlock;
-    set.numChannels = 1;
-    set.sampleRate = sampleRate;
-    left.prepare(set);
-    right.prepare(set);
-    auto chainSettings = getFilterSet(bleh);
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,chainSettings.peakFreq,chainSettings.peakQual,juce::Decibels::decibelsToGain(chainSettings.peakGain));
-    *left.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    *right.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-
-}
-
-void VonicRewriteAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool VonicRewriteAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void VonicRewriteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.f
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    auto chainSettings = getFilterSet(bleh);
-    auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),chainSettings.peakFreq,chainSettings.peakQual,juce::Decibels::decibelsToGain(chainSettings.peakGain));
-
-    auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,getSampleRate(),(chainSettings.lowCutSlope+1)*2);
-    
-    *left.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    *right.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    auto& leftLowCut = left.get<ChainPositions::LowCut>();
-
-
-    leftLowCut.setBypassed<0>(true);
-    leftLowCut.setBypassed<1>(true);
-    leftLowCut.setBypassed<2>(true);
-    leftLowCut.setBypassed<3>(true);
-
-    switch(chainSettings.lowCutSlope)
-    {
-        case grad12:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.setBypassed<0>(false);
-            break;
-        }
-        case grad24:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.setBypassed<0>(false);
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.setBypassed<1>(false);
-            break;
-        }
-        case grad36:{
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.setBypassed<0>(false);
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2];
-            leftLowCut.setBypassed<2>(false);
-            break;
-        }
-        case grad48:
-        {
-            *leftLowCut.get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.setBypassed<0>(false);
-            *leftLowCut.get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.setBypassed<1>(false);
-            *leftLowCut.get<2>().coefficients = *cutCoefficients[2];
-            leftLowCut.setBypassed<2>(false);
-            *leftLowCut.get<3>().coefficients = *cutCoefficients[3];
-            leftLowCut.setBypassed<3>(false);
-            break;
-        }
-    }
-    auto& rightLowCut = right.get<ChainPositions::LowCut>();
-    rightLowCut.setBypassed<0>(true);
-    rightLowCut.setBypassed<1>(true);
-    rightLowCut.setBypassed<2>(true);
-    rightLowCut.setBypassed<3>(true);
-
-    switch(chainSettings.lowCutSlope)
-    {
-        case grad12:
-        {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0];
-            rightLowCut.setBypassed<0>(false);
-            break;
-        }
-        case grad24:
-        {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0];
-            rightLowCut.setBypassed<0>(false);
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1];
-            rightLowCut.setBypassed<1>(false);
-            break;
-        }
-        case grad36:{
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0];
-            rightLowCut.setBypassed<0>(false);
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1];
-            rightLowCut.setBypassed<1>(false);
-            *rightLowCut.get<2>().coefficients = *cutCoefficients[2];
-            rightLowCut.setBypassed<2>(false);
-            break;
-        }
-        case grad48:
-        {
-            *rightLowCut.get<0>().coefficients = *cutCoefficients[0];
-            rightLowCut.setBypassed<0>(false);
-            *rightLowCut.get<1>().coefficients = *cutCoefficients[1];
-            rightLowCut.setBypassed<1>(false);
-            *rightLowCut.get<2>().coefficients = *cutCoefficients[2];
-            rightLowCut.setBypassed<2>(false);
-            *rightLowCut.get<3>().coefficients = *cutCoefficients[3];
-            rightLowCut.setBypassed<3>(false);
-            break;
-        }
-    }
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-
-    left.process(leftContext);
-    right.process(rightContext);
-
-}
-
-//==============================================================================
-bool VonicRewriteAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* VonicRewriteAudioProcessor::createEditor()
-{
- //   return new VonicRewriteAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
-}
-
-//==============================================================================
-void VonicRewriteAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-}
-
-void VonicRewriteAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    
-}
-FilterSet getFilterSet(juce::AudioProcessorValueTreeState& bleh){
-    FilterSet props;
-
-    props.lowCutFreq = bleh.getRawParameterValue("HighPass")->load();
-    props.highCutFreq = bleh.getRawParameterValue("LowPass")->load();
-    props.peakFreq = bleh.getRawParameterValue("Peak")->load();
-    props.peakGain = bleh.getRawParameterValue("Gain")->load();
-    props.peakQual = bleh.getRawParameterValue("Quality")->load();
-    props.lowCutSlope = static_cast<Gradient>(bleh.getRawParameterValue("HighPassGrad")->load());
-    props.highCutSlope = static_cast<Gradient>(bleh.getRawParameterValue("LowPassGrad")->load());
-    return props;
-}
-juce::AudioProcessorValueTreeState::ParameterLayout VonicRewriteAudioProcessor::createParams(){
-        juce::AudioProcessorValueTreeState::ParameterLayout map;
-        map.add(std::make_unique<juce::AudioParameterFloat>("HighPass","HighPass",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),20.f));
-        map.add(std::make_unique<juce::AudioParameterFloat>("LowPass","LowPass",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),20.f));
-
-    juce::StringArray choices;
-    for (int i = 0; i < 4; ++i)
-    {
-        juce::String brr;
-        brr << (12 + 12*i);
-        brr << "decibelsPerOct";
-        choices.add(brr);
-        /* code */
-    }
-    map.add(std::make_unique<juce::AudioParameterChoice>("HighPassGrad","HighPassGrad",choices,0));
-    map.add(std::make_unique<juce::AudioParameterChoice>("LowPassGrad","LowPassGrad",choices,0));
-
-        map.add(std::make_unique<juce::AudioParameterFloat>("Peak","Peak",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),750.f));
-        map.add(std::make_unique<juce::AudioParameterFloat>("Gain","Gain",juce::NormalisableRange<float>(-24.f,24.f,0.5f,1.f),0.f));
-        map.add(std::make_unique<juce::AudioParameterFloat>("Quality","Quality",juce::NormalisableRange<float>(0.1f,10.f,0.05f,1.f),1.f));
-    
-    
-    return map;
-    }
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new VonicRewriteAudioProcessor();
-}
+
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "ChainResponse.h"
+
+//==============================================================================
+VonicRewriteAudioProcessor::VonicRewriteAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Low",    juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("High",   juce::AudioChannelSet::stereo(), false)
+                     #endif
+                       )
+#endif
+{
+    // Builds the shared table here on the message thread, not on the first
+    // audio callback that needs it.
+    CoefficientCache::getInstance();
+
+    // e.g. VONIC_WORKER_THREADS=3 for big channel counts; see setNumWorkerThreads().
+    setNumWorkerThreads (juce::SystemStats::getEnvironmentVariable ("VONIC_WORKER_THREADS", "0").getIntValue());
+
+    // e.g. VONIC_QUALITY_THRESHOLDS=0.6,0.2 on a crowded mix server, or off.
+    // Only program fades are given up unless ",audible" is added.
+    qualityScheduler.setSettings (QualityScheduler::Settings::fromString (juce::SystemStats::getEnvironmentVariable ("VONIC_QUALITY_THRESHOLDS", {})));
+
+   #if VONIC_TELEMETRY
+    // With VONIC_TELEMETRY_DIR set (e.g. to /dev/shm), every instance also
+    // publishes its counters there as vonic-<uuid>.json.
+    const auto directory = juce::SystemStats::getEnvironmentVariable ("VONIC_TELEMETRY_DIR", {});
+
+    if (juce::File::isAbsolutePath (directory))
+        telemetryWriter = std::make_unique<TelemetryFileWriter> (telemetry, juce::File (directory).getChildFile ("vonic-" + juce::Uuid().toDashedString() + ".json"));
+   #endif
+}
+
+VonicRewriteAudioProcessor::~VonicRewriteAudioProcessor()
+{
+}
+
+//==============================================================================
+const juce::String VonicRewriteAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool VonicRewriteAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool VonicRewriteAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool VonicRewriteAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double VonicRewriteAudioProcessor::getTailLengthSeconds() const
+{
+    // Hosts ask from the message thread, so the chain is designed here from
+    // the current settings rather than taken from the audio thread.
+    FilterSet settings;
+
+    while (! parameterSnapshot.tryRead (settings))
+        std::this_thread::yield();
+
+    const auto sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    return ChainResponse::getTailLength (designChain (settings, sampleRate)) / sampleRate;
+}
+
+int VonicRewriteAudioProcessor::getNumPrograms()
+{
+    return juce::jmax (1, presetBank->getNumPresets());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                                                          // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int VonicRewriteAudioProcessor::getCurrentProgram()
+{
+    return currentProgram.load();
+}
+
+void VonicRewriteAudioProcessor::setCurrentProgram (int index)
+{
+    if (! juce::isPositiveAndBelow (index, presetBank->getNumPresets()))
+        return;
+
+    currentProgram = index;
+
+    // The parameters go first, so that by the time the audio thread sees the
+    // new program they already match its pre-designed chain.
+    setFilterSet (bleh, presetBank->getPreset (index).settings);
+    pendingProgram.store (index, std::memory_order_release);
+}
+
+const juce::String VonicRewriteAudioProcessor::getProgramName (int index)
+{
+    if (! juce::isPositiveAndBelow (index, presetBank->getNumPresets()))
+        return {};
+
+    return presetBank->getPreset (index).name;
+}
+
+void VonicRewriteAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+    // The bank is shared by every instance in the process, so one of them
+    // renaming a program isn't supported; edit the bank file instead.
+    juce::ignoreUnused (index, newName);
+}
+
+//==============================================================================
+void VonicRewriteAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Use this method as the place to do any pre-playback
+    // initialisation that you need..
+    juce::dsp::ProcessSpec set;
+    set.maximumBlockSize = samplesPerBlock;
+    set.numChannels = 1;
+    set.sampleRate = sampleRate;
+    const auto numChannels = juce::jmax (1, getMainBusNumOutputChannels());
+    chains.resize ((size_t) numChannels);
+    fadeChains.resize ((size_t) numChannels);
+
+    for (auto& chain : chains)
+        chain.prepare(set);
+
+    currentFilterSet = getFilterSet(bleh);
+    auto coefficients = designer(currentFilterSet,sampleRate);
+    updateChains(coefficients);
+    outputIsSilent = false;
+
+    presetSnapshot = presetBank->getSnapshot (sampleRate, [this] (const FilterSet& settings) { return snapToParameters (settings); });
+    pendingProgram = -1;
+
+    for (auto& chain : fadeChains)
+        chain.prepare(set);
+
+    fadeBuffer.setSize (numChannels, samplesPerBlock);
+    fadeLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.01));
+    fadeRemaining = 0;
+
+    crossoverEnabled = false;
+
+    for (int bus = 1; bus < getBusCount (false); ++bus)
+        crossoverEnabled = crossoverEnabled || getBus (false, bus)->isEnabled();
+
+    if (deterministic)
+        backgroundDesigner.release();
+    else
+        backgroundDesigner.prepare (sampleRate, crossoverEnabled, designer);
+
+    // One thread here is one core's worth of channels; more threads than
+    // cores would only take turns.
+    const auto numWorkers = juce::jmin (numWorkerThreads, numChannels - 1, juce::SystemStats::getNumCpus() - 1);
+
+    if (numWorkers > 0)
+        workerPool.start (numWorkers, samplesPerBlock, sampleRate);
+    else
+        workerPool.stop();
+
+    inputMeter.prepare (sampleRate, numChannels, samplesPerBlock, true, deterministic);
+    outputMeter.prepare (sampleRate, numChannels, samplesPerBlock, true, deterministic);
+    uncompensatedMeter.prepare (sampleRate, numChannels, samplesPerBlock, false, deterministic);
+    inputMetered = outputMetered = uncompensatedMetered = false;
+    loudnessResetPending = false;
+    maxBlockSize = samplesPerBlock;
+
+    autoGain.reset (sampleRate, 0.1);
+    autoGain.setCurrentAndTargetValue (1.0f);
+    autoGainDecibels = 0.0f;
+
+    appliedSerial = 0;
+    appliedSlopeLimit = grad96;
+    programPending = false;
+    qualityScheduler.prepare (sampleRate, numQualityLevels, slopesUpTo48, ! deterministic);
+
+    // Stands in for a band whose bus is disabled.
+    bandScratch.setSize (2, samplesPerBlock);
+
+    for (auto& crossover : crossovers)
+        crossover.reset();
+
+    if (crossoverEnabled)
+        updateCrossovers();
+
+   #if VONIC_TELEMETRY
+    telemetry.addRedesign();
+   #endif
+}
+
+void VonicRewriteAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    backgroundDesigner.release();
+    workerPool.stop();
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool VonicRewriteAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // Any layout up to maxChannels, from mono to an ambisonic or immersive
+    // bed; every channel gets the same EQ.
+    if (layouts.getMainOutputChannelSet().isDisabled()
+     || layouts.getMainOutputChannelSet().size() > maxChannels)
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    // The crossover's band outputs, when used, match the main output, which
+    // then has to be mono or stereo.
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+        if (! layouts.outputBuses[bus].isDisabled()
+             && (layouts.outputBuses[bus] != layouts.getMainOutputChannelSet()
+                  || layouts.getMainOutputChannelSet().size() > (int) crossovers.size()))
+            return false;
+
+    return true;
+  #endif
+}
+#endif
+
+void VonicRewriteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    const auto startTicks = QualityScheduler::startBlock();
+    const auto quality = getQualityLevel();
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // In case we have more outputs than inputs, this code clears any output
+    // channels that didn't contain input data, (because these aren't
+    // guaranteed to be empty - they may contain garbage).
+    // This is here to avoid people getting screaming feedback
+    // when they first compile a plugin, but obviously you don't need to keep
+    // this code if your algorithm always overwrites all the output channels.f
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    const auto program = pendingProgram.exchange (-1, std::memory_order_acquire);
+
+    if (program >= 0 && presetSnapshot != nullptr && program < (int) presetSnapshot->chains.size())
+    {
+        if (! outputIsSilent && ! crossoverEnabled && quality < noProgramFades)
+        {
+            std::copy (chains.begin(), chains.end(), fadeChains.begin());
+            fadeRemaining = fadeLength;
+        }
+
+        currentFilterSet = presetSnapshot->settings[(size_t) program];
+
+        // The bank's chains come from the platform's libm, so a deterministic
+        // instance designs its own.
+        const auto coefficients = deterministic ? designer (currentFilterSet, getSampleRate())
+                                                : presetSnapshot->chains[(size_t) program];
+        updateChains(coefficients);
+        appliedSlopeLimit = grad96;
+
+        // The bank has no crossovers, so outside deterministic mode those
+        // follow a block or so later from the background designer.
+        programVersion = parameterSnapshot.getVersion();
+        programPending = true;
+
+        if (crossoverEnabled && deterministic)
+            updateCrossovers();
+    }
+
+    if (deterministic)
+    {
+        // A deterministic render can't let thread timing decide which block a
+        // change lands in, so it waits out any (very short) publish instead.
+        auto filterSet = currentFilterSet;
+
+        while (! parameterSnapshot.tryRead (filterSet))
+            std::this_thread::yield();
+
+        if (filterSet != currentFilterSet)
+        {
+            currentFilterSet = filterSet;
+            auto coefficients = designer(currentFilterSet,getSampleRate());
+            updateChains(coefficients);
+
+            if (crossoverEnabled)
+                updateCrossovers();
+
+           #if VONIC_TELEMETRY
+            telemetry.addRedesign();
+           #endif
+        }
+    }
+    else
+    {
+        applyBackgroundDesign (quality >= slopesUpTo24 ? grad24
+                             : quality >= slopesUpTo48 ? grad48
+                                                       : grad96);
+    }
+
+    const auto numSamples = buffer.getNumSamples();
+
+    if (deterministic)
+        for (int ch = 0; ch < totalNumInputChannels; ++ch)
+            Determinism::flushDenormals (buffer.getWritePointer (ch), numSamples);
+
+    const auto inputIsSilent = buffer.getMagnitude (0, numSamples) == 0.f;
+
+    const auto metering = meteringEnabled.load (std::memory_order_relaxed);
+    const auto autoGainOn = ! deterministic && autoGainParameter != nullptr
+                              && autoGainParameter->load (std::memory_order_relaxed) >= 0.5f;
+    setMeterActive (inputMeter, inputMetered, metering || autoGainOn);
+    setMeterActive (uncompensatedMeter, uncompensatedMetered, autoGainOn);
+    setMeterActive (outputMeter, outputMetered, metering);
+
+    if (loudnessResetPending.exchange (false))
+    {
+        inputMeter.reset();
+        outputMeter.reset();
+    }
+
+    if (inputIsSilent && outputIsSilent)
+    {
+        if (inputMetered)
+            inputMeter.addSilence (numSamples);
+
+        if (uncompensatedMetered)
+            uncompensatedMeter.addSilence (numSamples);
+
+        if (outputMetered)
+            outputMeter.addSilence (numSamples);
+
+       #if VONIC_TELEMETRY
+        telemetry.addSkippedBlock();
+        telemetry.endBlock (startTicks);
+       #endif
+        endBlock (startTicks, numSamples);
+        return;
+    }
+
+    const auto numMainChannels = juce::jmin (getMainBusNumOutputChannels(), (int) chains.size());
+
+    // The meters move every 100 ms, and each move is ramped over the next.
+    setAutoGainTarget (autoGainOn);
+    const auto gainStart = autoGain.getCurrentValue();
+    const auto gainEnd = autoGain.skip (numSamples);
+    autoGainDecibels.store (juce::Decibels::gainToDecibels (gainEnd), std::memory_order_relaxed);
+
+    // A block whose input is silent can end with the tails being dropped
+    // below, which has to happen before the output is measured.
+    const auto meterInWorkers = ! crossoverEnabled && ! inputIsSilent && numMainChannels == (int) chains.size();
+
+    if (inputMetered && ! meterInWorkers)
+        inputMeter.process (buffer.getArrayOfReadPointers(), numSamples);
+
+    if (crossoverEnabled)
+        processCrossovers (buffer);
+
+    if (! crossoverEnabled)
+    {
+        // Channels don't share anything, so with workers running they are
+        // split into one group per thread. The buffers' pointers are taken
+        // here, since AudioBuffer's accessors aren't safe to call from
+        // several threads at once.
+        ChannelJob job;
+        job.processor = this;
+        job.channels = buffer.getArrayOfWritePointers();
+        job.fadeChannels = fadeBuffer.getArrayOfWritePointers();
+        job.numChannels = numMainChannels;
+        job.numTasks = juce::jmin (numMainChannels, workerPool.getNumWorkers() + 1);
+
+        if (meterInWorkers)
+        {
+            job.inputMeter = inputMetered ? &inputMeter : nullptr;
+            job.uncompensatedMeter = uncompensatedMetered ? &uncompensatedMeter : nullptr;
+            job.outputMeter = outputMetered ? &outputMeter : nullptr;
+            job.flushDenormals = deterministic;
+        }
+
+        // fadeBuffer and the meters' per-channel state only hold maxBlockSize
+        // samples, so a host that goes past that gets its block in slices.
+        const auto sliceLength = juce::jmax (1, maxBlockSize);
+
+        const auto getGainAt = [&] (int sample)
+        {
+            return sample == numSamples ? gainEnd : gainStart + (gainEnd - gainStart) * (float) sample / (float) numSamples;
+        };
+
+        for (int start = 0; start < numSamples; start += sliceLength)
+        {
+            const auto end = juce::jmin (numSamples, start + sliceLength);
+
+            job.startSample = start;
+            job.numSamples = end - start;
+            job.numFading = juce::jmin (job.numSamples, fadeRemaining);
+            job.fadeStart = 1.f - (float) fadeRemaining / (float) fadeLength;
+            job.fadeEnd = 1.f - (float) (fadeRemaining - job.numFading) / (float) fadeLength;
+
+            if (meterInWorkers)
+            {
+                job.gainStart = getGainAt (start);
+                job.gainEnd = getGainAt (end);
+            }
+
+            workerPool.run (job.numTasks, processChannels, &job);
+            fadeRemaining -= job.numFading;
+
+            for (auto* meter : { job.inputMeter, job.uncompensatedMeter, job.outputMeter })
+                if (meter != nullptr)
+                    meter->endBlock (job.numSamples);
+        }
+    }
+
+    // Once the tails have rung down below -180 dBFS, drop what is left of
+    // them; from then on silent blocks pass straight through.
+    if (inputIsSilent && buffer.getMagnitude (0, numSamples) < 1.0e-9f)
+    {
+        buffer.clear();
+
+        for (auto& chain : chains)
+            chain.reset();
+
+        for (auto& crossover : crossovers)
+            crossover.reset();
+
+        fadeRemaining = 0;
+        outputIsSilent = true;
+    }
+    else
+    {
+        outputIsSilent = false;
+
+        if (deterministic)
+            for (int ch = meterInWorkers ? numMainChannels : 0; ch < buffer.getNumChannels(); ++ch)
+                Determinism::flushDenormals (buffer.getWritePointer (ch), numSamples);
+    }
+
+    if (! meterInWorkers)
+    {
+        if (uncompensatedMetered)
+            uncompensatedMeter.process (buffer.getArrayOfReadPointers(), numSamples);
+
+        if (gainStart != 1.0f || gainEnd != 1.0f)
+            for (int ch = 0; ch < numMainChannels; ++ch)
+                buffer.applyGainRamp (ch, 0, numSamples, gainStart, gainEnd);
+
+        if (outputMetered)
+            outputMeter.process (buffer.getArrayOfReadPointers(), numSamples);
+    }
+
+   #if VONIC_TELEMETRY
+    auto numResets = crossovers[0].getNumResets() + crossovers[1].getNumResets();
+
+    for (auto& chain : chains)
+        numResets += getNumResets (chain);
+
+    if (numResets != lastNumResets)
+    {
+        telemetry.addStateResets (numResets - lastNumResets);
+        lastNumResets = numResets;
+    }
+
+    telemetry.endBlock (startTicks);
+   #endif
+    endBlock (startTicks, numSamples);
+}
+
+void VonicRewriteAudioProcessor::endBlock (juce::int64 startTicks, int numSamples) noexcept
+{
+    if (! isNonRealtime())
+        qualityScheduler.endBlock (startTicks, numSamples);
+}
+
+void VonicRewriteAudioProcessor::setMeterActive (LoudnessMeter& meter, bool& active, bool shouldBeActive) noexcept
+{
+    // Time it spent off would otherwise count as silence.
+    if (shouldBeActive && ! active)
+        meter.reset();
+
+    active = shouldBeActive;
+}
+
+void VonicRewriteAudioProcessor::setAutoGainTarget (bool enabled) noexcept
+{
+    if (! enabled)
+    {
+        autoGain.setTargetValue (1.0f);
+        return;
+    }
+
+    // Held until both meters have a full 3 s to compare, and where either
+    // side is too quiet to measure, as in silence.
+    if (! inputMeter.isShortTermComplete() || ! uncompensatedMeter.isShortTermComplete())
+        return;
+
+    const auto input = inputMeter.getReadings().shortTerm;
+    const auto output = uncompensatedMeter.getReadings().shortTerm;
+
+    if (input > LoudnessMeter::absoluteGate && output > LoudnessMeter::absoluteGate)
+        autoGain.setTargetValue (juce::Decibels::decibelsToGain (juce::jlimit (-maxAutoGainDecibels, maxAutoGainDecibels, input - output)));
+}
+
+int VonicRewriteAudioProcessor::getQualityLevel() const noexcept
+{
+    return isNonRealtime() ? fullQuality : qualityScheduler.getLevel();
+}
+
+juce::String VonicRewriteAudioProcessor::getQualityDescription (int level)
+{
+    switch (level)
+    {
+        case noProgramFades: return "program fades off";
+        case slopesUpTo48:   return "cuts held to 48 dB/oct, program fades off";
+        case slopesUpTo24:   return "cuts held to 24 dB/oct, program fades off";
+        default:             break;
+    }
+
+    return "full quality";
+}
+
+void VonicRewriteAudioProcessor::setDeterministic (bool shouldBeDeterministic) noexcept
+{
+    deterministic = shouldBeDeterministic;
+    designer = deterministic ? Determinism::designChain : designChainCached;
+}
+
+ChainCoefficients VonicRewriteAudioProcessor::designCurrentChain()
+{
+    FilterSet settings;
+
+    if (! parameterSnapshot.tryRead (settings))
+        settings = getFilterSet (bleh);
+
+    return designer (settings, getSampleRate() > 0.0 ? getSampleRate() : 44100.0);
+}
+
+void VonicRewriteAudioProcessor::applyBackgroundDesign (Gradient slopeLimit)
+{
+    const auto* design = backgroundDesigner.beginRead();
+
+    // Signed, so that the comparison survives the version wrapping round.
+    const auto isStale = [this] (const BackgroundDesigner::Design& d)
+    {
+        return programPending && (juce::int32) (d.version - programVersion) < 0;
+    };
+
+    // Every set carries each cap's coefficients, so a change of cap is
+    // picked up here without waiting for the designer.
+    if (design != nullptr && (design->serial != appliedSerial || slopeLimit != appliedSlopeLimit) && ! isStale (*design))
+    {
+        appliedSerial = design->serial;
+        programPending = false;
+
+        // After a program switch the chain is already right, unless its
+        // slopes have to be capped, but the crossovers still need the new
+        // splits.
+        if (design->settings != currentFilterSet || slopeLimit != appliedSlopeLimit || crossoverEnabled)
+        {
+            const auto& coefficients = design->getCoefficients (slopeLimit);
+            currentFilterSet = design->settings;
+            appliedSlopeLimit = slopeLimit;
+            updateChains(coefficients.chain);
+
+            if (crossoverEnabled)
+                for (auto& crossover : crossovers)
+                    crossover.setCoefficients (coefficients.crossover);
+
+           #if VONIC_TELEMETRY
+            telemetry.addRedesign();
+           #endif
+        }
+    }
+
+    backgroundDesigner.endRead();
+}
+
+void VonicRewriteAudioProcessor::updateCrossovers()
+{
+    const auto coefficients = designCrossover (currentFilterSet, getSampleRate(), designer);
+
+    for (auto& crossover : crossovers)
+        crossover.setCoefficients (coefficients);
+}
+
+void VonicRewriteAudioProcessor::processCrossovers (juce::AudioBuffer<float>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+    auto main = getBusBuffer (buffer, false, 0);
+    auto lowBus = getBusBuffer (buffer, false, 1);
+    auto highBus = getBusBuffer (buffer, false, 2);
+
+    // bandScratch is sized in prepareToPlay(), and longer blocks go through
+    // it a slice at a time.
+    const auto sliceLength = juce::jmax (1, bandScratch.getNumSamples());
+
+    for (int ch = 0; ch < juce::jmin (main.getNumChannels(), (int) crossovers.size()); ++ch)
+    {
+        for (int start = 0; start < numSamples; start += sliceLength)
+        {
+            // A disabled band is split off all the same and dropped, as the
+            // plain cut would do.
+            auto* low = ch < lowBus.getNumChannels() ? lowBus.getWritePointer (ch, start) : bandScratch.getWritePointer (0);
+            auto* high = ch < highBus.getNumChannels() ? highBus.getWritePointer (ch, start) : bandScratch.getWritePointer (1);
+
+            crossovers[(size_t) ch].process (low, main.getWritePointer (ch, start), high, juce::jmin (sliceLength, numSamples - start));
+        }
+    }
+}
+
+void VonicRewriteAudioProcessor::processChannels (void* context, int taskIndex) noexcept
+{
+    const auto& job = *static_cast<const ChannelJob*> (context);
+    auto& processor = *job.processor;
+    const auto group = WorkerPool::getGroup (job.numChannels, job.numTasks, taskIndex);
+
+    for (auto ch = group.getStart(); ch < group.getEnd(); ++ch)
+    {
+        auto* samples = job.channels[ch] + job.startSample;
+
+        if (job.inputMeter != nullptr)
+            job.inputMeter->processChannel (ch, samples, job.numSamples);
+
+        if (job.numFading > 0)
+            juce::FloatVectorOperations::copy (job.fadeChannels[ch], samples, job.numFading);
+
+        processor.chains[(size_t) ch].process (samples, job.numSamples);
+
+        if (job.numFading > 0)
+        {
+            // The old chain's output fades out under the new one's, with the
+            // same ramp as AudioBuffer::applyGainRamp().
+            auto* faded = job.fadeChannels[ch];
+            processor.fadeChains[(size_t) ch].process (faded, job.numFading);
+
+            const auto increment = (job.fadeEnd - job.fadeStart) / (float) job.numFading;
+            auto gain = job.fadeStart;
+
+            for (int i = 0; i < job.numFading; ++i)
+            {
+                samples[i] = samples[i] * gain + faded[i] * (1.f - gain);
+                gain += increment;
+            }
+        }
+
+        if (job.flushDenormals)
+            Determinism::flushDenormals (samples, job.numSamples);
+
+        if (job.uncompensatedMeter != nullptr)
+            job.uncompensatedMeter->processChannel (ch, samples, job.numSamples);
+
+        // The auto gain, the same as AudioBuffer::applyGainRamp() too.
+        if (job.gainStart == job.gainEnd)
+        {
+            if (job.gainStart != 1.f)
+                juce::FloatVectorOperations::multiply (samples, job.gainStart, job.numSamples);
+        }
+        else
+        {
+            const auto increment = (job.gainEnd - job.gainStart) / (float) job.numSamples;
+            auto gain = job.gainStart;
+
+            for (int i = 0; i < job.numSamples; ++i)
+            {
+                samples[i] *= gain;
+                gain += increment;
+            }
+        }
+
+        if (job.outputMeter != nullptr)
+            job.outputMeter->processChannel (ch, samples, job.numSamples);
+    }
+}
+
+void VonicRewriteAudioProcessor::setNumWorkerThreads (int numThreads) noexcept
+{
+    numWorkerThreads = juce::jmax (0, numThreads);
+}
+
+void VonicRewriteAudioProcessor::updateChain (MonoChain& chain, const ChainCoefficients& coefficients)
+{
+    chain.setCoefficients (coefficients);
+}
+
+void VonicRewriteAudioProcessor::updateChains (const ChainCoefficients& coefficients)
+{
+    // A new slope swaps in a cut made of different sections, which start
+    // from silence (see Cascade::setCoefficients()), so the old chains fade
+    // out under the new ones, as they do for a program change.
+    if (! chains.empty() && ! chains.front().hasSameSections (coefficients)
+         && ! outputIsSilent && ! crossoverEnabled && getQualityLevel() < noProgramFades)
+    {
+        std::copy (chains.begin(), chains.end(), fadeChains.begin());
+        fadeRemaining = fadeLength;
+    }
+
+    for (auto& chain : chains)
+        updateChain (chain, coefficients);
+}
+
+juce::uint32 VonicRewriteAudioProcessor::getNumResets (const MonoChain& chain) noexcept
+{
+    return chain.getNumResets();
+}
+
+//==============================================================================
+bool VonicRewriteAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* VonicRewriteAudioProcessor::createEditor()
+{
+    return new VonicRewriteAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void VonicRewriteAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // The parameters, plus the program they were last loaded from so that
+    // the host shows the same one when the session is reopened.
+    auto state = bleh.copyState();
+    state.setProperty ("Program", currentProgram.load(), nullptr);
+
+    if (auto xml = state.createXml())
+        copyXmlToBinary (*xml, destData);
+}
+
+// The slopes used to be "HighPassGrad" and "LowPassGrad", with only 12, 24,
+// 36 and 48 dB/oct to choose from. They were renamed when the 6 dB steps
+// came in, so that old automation can't land on the wrong slope; this moves
+// an old session's choices over to the new parameters.
+static void migrateSlopeParameters (juce::ValueTree& state)
+{
+    constexpr Gradient oldSlopes[] { grad12, grad24, grad36, grad48 };
+    const std::pair<const char*, const char*> renames[] { { "HighPassGrad", "HighPassSlope" }, { "LowPassGrad", "LowPassSlope" } };
+
+    for (auto& [oldID, newID] : renames)
+    {
+        auto parameter = state.getChildWithProperty ("id", oldID);
+
+        if (! parameter.isValid() || state.getChildWithProperty ("id", newID).isValid())
+            continue;
+
+        const auto index = juce::jlimit (0, 3, juce::roundToInt ((double) parameter.getProperty ("value")));
+        parameter.setProperty ("id", newID, nullptr);
+        parameter.setProperty ("value", (int) oldSlopes[index], nullptr);
+    }
+}
+
+void VonicRewriteAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    const auto xml = getXmlFromBinary (data, sizeInBytes);
+
+    if (xml == nullptr || ! xml->hasTagName (bleh.state.getType()))
+        return;
+
+    auto state = juce::ValueTree::fromXml (*xml);
+
+    // Only the index: the saved parameters may have been edited since the
+    // program was loaded, so they win over its settings.
+    const auto program = (int) state.getProperty ("Program", 0);
+    currentProgram = juce::isPositiveAndBelow (program, presetBank->getNumPresets()) ? program : 0;
+    state.removeProperty ("Program", nullptr);
+    migrateSlopeParameters (state);
+
+    bleh.replaceState (state);
+}
+
+FilterSet getFilterSet(juce::AudioProcessorValueTreeState& bleh){
+    FilterSet props;
+
+    props.lowCutFreq = bleh.getRawParameterValue("HighPass")->load();
+    props.highCutFreq = bleh.getRawParameterValue("LowPass")->load();
+    props.peakFreq = bleh.getRawParameterValue("Peak")->load();
+    props.peakGain = bleh.getRawParameterValue("Gain")->load();
+    props.peakQual = bleh.getRawParameterValue("Quality")->load();
+    props.lowCutSlope = static_cast<Gradient>(bleh.getRawParameterValue("HighPassSlope")->load());
+    props.highCutSlope = static_cast<Gradient>(bleh.getRawParameterValue("LowPassSlope")->load());
+    return props;
+}
+static void setParameter (juce::AudioProcessorValueTreeState& bleh, const juce::String& parameterID, float value)
+{
+    if (auto* parameter = bleh.getParameter (parameterID))
+    {
+        parameter->beginChangeGesture();
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+        parameter->endChangeGesture();
+    }
+}
+
+FilterSet VonicRewriteAudioProcessor::snapToParameters (const FilterSet& settings) const
+{
+    // Same round trip as a host automating the parameter, so the result
+    // compares equal to what getFilterSet() will read back.
+    auto snap = [this] (const char* parameterID, float value)
+    {
+        auto* parameter = bleh.getParameter (parameterID);
+        return parameter->convertFrom0to1 (parameter->convertTo0to1 (value));
+    };
+
+    FilterSet snapped;
+    snapped.lowCutFreq = snap ("HighPass", settings.lowCutFreq);
+    snapped.highCutFreq = snap ("LowPass", settings.highCutFreq);
+    snapped.peakFreq = snap ("Peak", settings.peakFreq);
+    snapped.peakGain = snap ("Gain", settings.peakGain);
+    snapped.peakQual = snap ("Quality", settings.peakQual);
+    snapped.lowCutSlope = static_cast<Gradient> (snap ("HighPassSlope", (float) settings.lowCutSlope));
+    snapped.highCutSlope = static_cast<Gradient> (snap ("LowPassSlope", (float) settings.highCutSlope));
+    return snapped;
+}
+
+void setFilterSet (juce::AudioProcessorValueTreeState& bleh, const FilterSet& settings)
+{
+    setParameter (bleh, "HighPass", settings.lowCutFreq);
+    setParameter (bleh, "LowPass", settings.highCutFreq);
+    setParameter (bleh, "Peak", settings.peakFreq);
+    setParameter (bleh, "Gain", settings.peakGain);
+    setParameter (bleh, "Quality", settings.peakQual);
+    setParameter (bleh, "HighPassSlope", (float) settings.lowCutSlope);
+    setParameter (bleh, "LowPassSlope", (float) settings.highCutSlope);
+}
+juce::AudioProcessorValueTreeState::ParameterLayout VonicRewriteAudioProcessor::createParams(){
+        juce::AudioProcessorValueTreeState::ParameterLayout map;
+        map.add(std::make_unique<juce::AudioParameterFloat>("HighPass","HighPass",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),20.f));
+        map.add(std::make_unique<juce::AudioParameterFloat>("LowPass","LowPass",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),20000.f));
+
+    juce::StringArray choices;
+    for (int i = 0; i < numGradients; ++i)
+    {
+        juce::String brr;
+        brr << getDecibelsPerOctave (static_cast<Gradient> (i));
+        brr << "decibelsPerOct";
+        choices.add(brr);
+    }
+    map.add(std::make_unique<juce::AudioParameterChoice>("HighPassSlope","HighPassSlope",choices,grad12));
+    map.add(std::make_unique<juce::AudioParameterChoice>("LowPassSlope","LowPassSlope",choices,grad12));
+
+        map.add(std::make_unique<juce::AudioParameterFloat>("Peak","Peak",juce::NormalisableRange<float>(20.f,20000.f,1.f,1.f),750.f));
+        map.add(std::make_unique<juce::AudioParameterFloat>("Gain","Gain",juce::NormalisableRange<float>(-24.f,24.f,0.5f,1.f),0.f));
+        map.add(std::make_unique<juce::AudioParameterFloat>("Quality","Quality",juce::NormalisableRange<float>(0.1f,10.f,0.05f,1.f),1.f));
+
+    // Matches the output's loudness to the input's; see setAutoGainTarget().
+    map.add (std::make_unique<juce::AudioParameterBool> ("AutoGain", "AutoGain", false));
+    
+    
+    return map;
+    }
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new VonicRewriteAudioProcessor();
+}
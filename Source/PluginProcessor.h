@@ -1,86 +1,263 @@
-
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-enum Gradient{
-  grad12,
-  grad24,
-  grad36,
-  grad48
-};
-struct FilterSet{
-  float peakFreq {0},peakGain{0},peakQual{1.f};
-  float lowCutFreq {0},highCutFreq {0};
-  Gradient lowCutSlope {Gradient::grad12},highCutSlope{Gradient::grad12};
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& bleh);
-
-//==============================================================================
-/**
-*/
-class VonicRewriteAudioProcessor  : public juce::AudioProcessor
-                            #if JucePlugin_Enable_ARA
-                             , public juce::AudioProcessorARAExtension
-                            #endif
-{
-public:
-    //==============================================================================
-    VonicRewriteAudioProcessor();
-    ~VonicRewriteAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-    juce::AudioProcessorValueTreeState::ParameterLayout createParams();
-    juce::AudioProcessorValueTreeState bleh{*this,nullptr,"HOHO",createParams()};
-private:
-    using Filter = juce::dsp::IIR::Filter<float>;
-    using CutFilter = juce::dsp::ProcessorChain<Filter,Filter,Filter,Filter>;
-    using MonoChain = juce::dsp::ProcessorChain<CutFilter,Filter,CutFilter>;
-    MonoChain left,right;
-    enum ChainPositions{
-      LowCut,
-      Peak,
-      HighCut
-    };
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VonicRewriteAudioProcessor)
-};
+
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+#include "Telemetry.h"
+#include "PresetBank.h"
+#include "CoefficientCache.h"
+#include "Crossover.h"
+#include "ParameterSnapshot.h"
+#include "Determinism.h"
+#include "BackgroundDesigner.h"
+#include "QualityScheduler.h"
+#include "WorkerPool.h"
+#include "LoudnessMeter.h"
+
+FilterSet getFilterSet(juce::AudioProcessorValueTreeState& bleh);
+
+/** The reverse of getFilterSet(): moves the parameters to match settings,
+    notifying the host as if the user had done it.
+*/
+void setFilterSet (juce::AudioProcessorValueTreeState& bleh, const FilterSet& settings);
+
+//==============================================================================
+/**
+*/
+class VonicRewriteAudioProcessor  : public juce::AudioProcessor
+                            #if JucePlugin_Enable_ARA
+                             , public juce::AudioProcessorARAExtension
+                            #endif
+{
+public:
+    //==============================================================================
+    VonicRewriteAudioProcessor();
+    ~VonicRewriteAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+    juce::AudioProcessorValueTreeState::ParameterLayout createParams();
+    juce::AudioProcessorValueTreeState bleh{*this,nullptr,"HOHO",createParams()};
+
+    /** Rounds settings to what the parameters would actually store. */
+    FilterSet snapToParameters (const FilterSet& settings) const;
+
+    /** Makes the output bit-identical on every machine (see Determinism.h),
+        at some cost in speed. Call before prepareToPlay().
+    */
+    void setDeterministic (bool shouldBeDeterministic) noexcept;
+    bool isDeterministic() const noexcept { return deterministic; }
+
+    /** The main bus takes up to this many channels, all with the same EQ. */
+    static constexpr int maxChannels = 64;
+
+    /** Off (0) by default. With more channels than one core can filter in
+        time, up to this many extra threads share them out in processBlock.
+        Capped at one less than the channels and the cores. Call before
+        prepareToPlay(), or set VONIC_WORKER_THREADS.
+    */
+    void setNumWorkerThreads (int numThreads) noexcept;
+    int getNumWorkerThreads() const noexcept { return numWorkerThreads; }
+
+    /** The chain processBlock runs for the parameters as they are now, at the
+        current sample rate. Safe to call from any thread; pass it to
+        ChainResponse to see what the EQ is doing without running audio.
+    */
+    ChainCoefficients designCurrentChain();
+
+    /** What qualityScheduler's levels give up, one more thing per level.
+        Capping the slopes changes the sound, so the scheduler only goes that
+        far when VONIC_QUALITY_THRESHOLDS asks for it.
+    */
+    enum QualityLevel
+    {
+        fullQuality,
+        noProgramFades,     // program and slope switches jump instead of crossfading
+        slopesUpTo48,       // cuts steeper than 48 dB/oct are designed at 48
+        slopesUpTo24,
+        numQualityLevels
+    };
+
+    /** The level processBlock is running at, and a line for the editor. */
+    int getQualityLevel() const noexcept;
+    static juce::String getQualityDescription (int level);
+
+    /** Call before prepareToPlay(). Defaults come from VONIC_QUALITY_THRESHOLDS. */
+    QualityScheduler& getQualityScheduler() noexcept   { return qualityScheduler; }
+    const QualityScheduler& getQualityScheduler() const noexcept   { return qualityScheduler; }
+
+    /** BS.1770 loudness of the main bus before and after the EQ (and the
+        auto gain). Safe to call from any thread. Only measured while
+        metering is on, apart from the input while AutoGain needs it.
+    */
+    LoudnessMeter::Readings getInputLoudness() const noexcept    { return inputMeter.getReadings(); }
+    LoudnessMeter::Readings getOutputLoudness() const noexcept   { return outputMeter.getReadings(); }
+
+    /** The editor turns this on while it's open. A meter that has been off
+        starts over when it comes back on.
+    */
+    void setMeteringEnabled (bool shouldMeter) noexcept   { meteringEnabled = shouldMeter; }
+
+    /** Starts both meters' integrated loudness and true peak over, from the
+        next block.
+    */
+    void resetLoudness() noexcept   { loudnessResetPending = true; }
+
+    /** The gain the AutoGain parameter is applying now, in dB. */
+    float getAutoGainDecibels() const noexcept   { return autoGainDecibels.load (std::memory_order_relaxed); }
+
+    /** Furthest the auto gain will go either way, in dB. */
+    static constexpr float maxAutoGainDecibels = 24.0f;
+
+   #if VONIC_TELEMETRY
+    /** Counters for this instance, safe to read from any thread. */
+    const Telemetry& getTelemetry() const noexcept { return telemetry; }
+   #endif
+private:
+    // Low cut, peak and high cut, fused into one pass over the block, for
+    // each channel of the main bus.
+    using MonoChain = Cascade;
+    std::vector<MonoChain> chains;
+    static void updateChain (MonoChain& chain, const ChainCoefficients& coefficients);
+    void updateChains (const ChainCoefficients& coefficients);
+    static juce::uint32 getNumResets (const MonoChain& chain) noexcept;
+
+    // Read once per block instead of looking each parameter up by name.
+    ParameterSnapshot parameterSnapshot { bleh };
+
+    // Coefficients are only redesigned when the parameters actually move,
+    // on backgroundDesigner's thread. appliedSerial is the last set copied
+    // in, and appliedSlopeLimit the quality level's cap it was copied under.
+    // After a program switch, sets older than the parameter version it
+    // brought were designed from the settings before it, and are skipped.
+    FilterSet currentFilterSet;
+    BackgroundDesigner backgroundDesigner { parameterSnapshot };
+    juce::uint32 appliedSerial = 0;
+    Gradient appliedSlopeLimit = grad96;
+    juce::uint32 programVersion = 0;
+    bool programPending = false;
+    void applyBackgroundDesign (Gradient slopeLimit);
+
+    // Steps quality down when processBlock gets near its deadline. Left at
+    // full quality in deterministic mode and when rendering offline, where
+    // the output mustn't depend on how busy the machine is.
+    QualityScheduler qualityScheduler;
+    void endBlock (juce::int64 startTicks, int numSamples) noexcept;
+
+    // Deterministic instances design on the audio thread instead, so that
+    // the block a change lands in doesn't depend on thread timing.
+    bool deterministic = false;
+    ChainDesigner designer = designChainCached;
+
+    // With the Low or High output bus enabled, the cuts become a crossover
+    // and the main output carries the mid band. Decided in prepareToPlay.
+    bool crossoverEnabled = false;
+    std::array<Crossover, 2> crossovers;
+    juce::AudioBuffer<float> bandScratch;
+    void updateCrossovers();
+    void processCrossovers (juce::AudioBuffer<float>& buffer);
+
+    // Set once the output has decayed to nothing, so that silent input can
+    // skip the filters entirely until something comes in again.
+    bool outputIsSilent = false;
+
+    // Programs come from the bank shared by every instance. A switch hands
+    // its index to the audio thread, which picks up the pre-designed chain
+    // and crossfades to it from a copy of the old one.
+    juce::SharedResourcePointer<PresetBank> presetBank;
+    std::shared_ptr<const PresetBank::Snapshot> presetSnapshot;
+    std::atomic<int> currentProgram { 0 }, pendingProgram { -1 };
+    std::vector<MonoChain> fadeChains;
+    juce::AudioBuffer<float> fadeBuffer;
+    int fadeLength = 0, fadeRemaining = 0;
+
+    // A third meter measures the EQ's output before the gain, and with
+    // AutoGain on the gain makes its short-term loudness match the input's.
+    // Each meter only runs while something reads it: the input and output
+    // ones while the editor is open, the input and uncompensated ones while
+    // AutoGain is on. The gain holds until both of its meters have 3 s
+    // behind them. Deterministic instances leave the gain alone, since it
+    // comes from libm's log10 and pow.
+    //
+    // Where the channels go to the workers, each channel is measured on the
+    // worker that filters it, and the blocks are finished afterwards here;
+    // otherwise the meters run here, around the filters.
+    LoudnessMeter inputMeter, outputMeter, uncompensatedMeter;
+    std::atomic<bool> meteringEnabled { false };
+    bool inputMetered = false, outputMetered = false, uncompensatedMetered = false;
+    std::atomic<float>* autoGainParameter = bleh.getRawParameterValue ("AutoGain");
+    juce::SmoothedValue<float> autoGain;
+    std::atomic<float> autoGainDecibels { 0.0f };
+    std::atomic<bool> loudnessResetPending { false };
+    void setAutoGainTarget (bool enabled) noexcept;
+    static void setMeterActive (LoudnessMeter& meter, bool& active, bool shouldBeActive) noexcept;
+
+    // Started in prepareToPlay() when worker threads were asked for. Each
+    // task filters (and crossfades, and meters) one group of channels.
+    int numWorkerThreads = 0, maxBlockSize = 0;
+    WorkerPool workerPool;
+
+    struct ChannelJob
+    {
+        VonicRewriteAudioProcessor* processor = nullptr;
+        float* const* channels = nullptr;
+        float* const* fadeChannels = nullptr;
+        int numChannels = 0, numTasks = 0, startSample = 0, numSamples = 0, numFading = 0;
+        float fadeStart = 0.f, fadeEnd = 0.f;
+
+        // Left null, with the gain at 1, when the meters run here instead.
+        LoudnessMeter* inputMeter = nullptr;
+        LoudnessMeter* uncompensatedMeter = nullptr;
+        LoudnessMeter* outputMeter = nullptr;
+        float gainStart = 1.f, gainEnd = 1.f;
+        bool flushDenormals = false;
+    };
+
+    static void processChannels (void* context, int taskIndex) noexcept;
+
+   #if VONIC_TELEMETRY
+    Telemetry telemetry;
+    std::unique_ptr<TelemetryFileWriter> telemetryWriter;
+    juce::uint32 lastNumResets = 0;
+   #endif
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VonicRewriteAudioProcessor)
+};
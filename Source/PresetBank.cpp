@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+static FilterSet makeSettings (float lowCut, int lowCutSlope, float highCut, int highCutSlope,
+                               float peak, float peakGain, float peakQ)
+{
+    FilterSet settings;
+    settings.lowCutFreq = lowCut;
+    settings.lowCutSlope = makeGradient (lowCutSlope);
+    settings.highCutFreq = highCut;
+    settings.highCutSlope = makeGradient (highCutSlope);
+    settings.peakFreq = peak;
+    settings.peakGain = peakGain;
+    settings.peakQual = peakQ;
+    return settings;
+}
+
+PresetBank::PresetBank()
+{
+    const auto file = getDefaultFile();
+
+    if (file.existsAsFile())
+        if (auto xml = juce::parseXML (file))
+            presets = parse (*xml);
+
+    if (presets.empty())
+        presets = getFactoryPresets();
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("Vonic")
+               .getChildFile ("Presets.xml");
+}
+
+std::vector<PresetBank::Preset> PresetBank::parse (const juce::XmlElement& xml)
+{
+    std::vector<Preset> result;
+
+    if (! xml.hasTagName ("VonicPresets"))
+        return result;
+
+    for (auto* element : xml.getChildWithTagNameIterator ("Preset"))
+    {
+        // Defaults match the plugin's parameters.
+        result.push_back ({ element->getStringAttribute ("name", "Preset " + juce::String ((int) result.size() + 1)),
+                            makeSettings ((float) element->getDoubleAttribute ("lowCut", 20.0),
+                                          element->getIntAttribute ("lowCutSlope", 12),
+                                          (float) element->getDoubleAttribute ("highCut", 20000.0),
+                                          element->getIntAttribute ("highCutSlope", 12),
+                                          (float) element->getDoubleAttribute ("peak", 750.0),
+                                          (float) element->getDoubleAttribute ("peakGain", 0.0),
+                                          (float) element->getDoubleAttribute ("peakQ", 1.0)) });
+    }
+
+    return result;
+}
+
+std::vector<PresetBank::Preset> PresetBank::getFactoryPresets()
+{
+    return { { "Flat",          makeSettings (20.f,  12, 20000.f, 12, 750.f,   0.f,  1.f) },
+             { "Vocal Low Cut", makeSettings (80.f,  24, 20000.f, 12, 750.f,   0.f,  1.f) },
+             { "Mud Cut",       makeSettings (40.f,  12, 20000.f, 12, 300.f,  -4.f,  1.4f) },
+             { "Air",           makeSettings (20.f,  12, 20000.f, 12, 12000.f, 4.f,  0.7f) },
+             { "Telephone",     makeSettings (300.f, 48, 3400.f,  48, 1000.f,  6.f,  1.f) } };
+}
+
+//==============================================================================
+std::shared_ptr<const PresetBank::Snapshot> PresetBank::getSnapshot (double sampleRate,
+                                                                   const std::function<FilterSet (const FilterSet&)>& snapToParameters)
+{
+    const juce::ScopedLock sl (snapshotLock);
+
+    for (auto& snapshot : snapshots)
+        if (snapshot->sampleRate == sampleRate)
+            return snapshot;
+
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->sampleRate = sampleRate;
+
+    for (auto& preset : presets)
+    {
+        snapshot->settings.push_back (snapToParameters (preset.settings));
+        snapshot->chains.push_back (designChain (snapshot->settings.back(), sampleRate));
+    }
+
+    snapshots.push_back (snapshot);
+    return snapshot;
+}
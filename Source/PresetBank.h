@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+
+    The plugin's programs. The bank is read once per process (through a
+    juce::SharedResourcePointer) and shared by every instance, and each
+    sample rate in use gets one set of pre-designed chains, so switching
+    program never runs the filter designers on the audio thread.
+
+    The bank lives in <user application data>/Vonic/Presets.xml:
+
+        <VonicPresets>
+          <Preset name="Vocal" lowCut="80" lowCutSlope="24" highCut="18000"
+                  highCutSlope="12" peak="3000" peakGain="2" peakQ="0.7"/>
+        </VonicPresets>
+
+    Missing attributes take the plugin's defaults. Without a bank file a
+    small factory set is used instead.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+class PresetBank
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        FilterSet settings;
+    };
+
+    /** Every preset designed for one sample rate, immutable once built.
+        settings holds each preset as the parameters will actually store it,
+        which is what the processor compares against to skip redesigning.
+    */
+    struct Snapshot
+    {
+        double sampleRate = 0.0;
+        std::vector<FilterSet> settings;
+        std::vector<ChainCoefficients> chains;
+    };
+
+    PresetBank();
+
+    int getNumPresets() const noexcept                  { return (int) presets.size(); }
+    const Preset& getPreset (int index) const           { return presets[(size_t) index]; }
+
+    /** Returns the designs for this sample rate, building them the first time
+        any instance asks. snapToParameters rounds a preset to the parameters'
+        steps. Not for the audio thread.
+    */
+    std::shared_ptr<const Snapshot> getSnapshot (double sampleRate, const std::function<FilterSet (const FilterSet&)>& snapToParameters);
+
+    static juce::File getDefaultFile();
+
+    /** Reads presets from a bank's XML, skipping anything it doesn't recognise. */
+    static std::vector<Preset> parse (const juce::XmlElement& xml);
+
+private:
+    static std::vector<Preset> getFactoryPresets();
+
+    std::vector<Preset> presets;
+
+    juce::CriticalSection snapshotLock;
+    std::vector<std::shared_ptr<const Snapshot>> snapshots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    QualityScheduler.cpp
+
+  ==============================================================================
+*/
+
+#include "QualityScheduler.h"
+
+QualityScheduler::Settings QualityScheduler::Settings::fromString (const juce::String& text)
+{
+    Settings result;
+    const auto trimmed = text.trim();
+
+    if (trimmed.isEmpty())
+        return result;
+
+    if (trimmed.equalsIgnoreCase ("off"))
+    {
+        result.stepDownAbove = 0.0;
+        return result;
+    }
+
+    const auto tokens = juce::StringArray::fromTokens (trimmed, ",", {});
+    result.stepDownAbove = tokens[0].getDoubleValue();
+
+    if (tokens.size() > 1)
+        result.stepUpBelow = tokens[1].getDoubleValue();
+
+    result.allowAudibleLevels = tokens[2].trim().equalsIgnoreCase ("audible");
+
+    // Coming back up has to be at a lower usage than stepping down, or the
+    // level would go straight back to where it was.
+    result.stepUpBelow = juce::jmin (result.stepUpBelow, result.stepDownAbove * 0.5);
+    return result;
+}
+
+void QualityScheduler::prepare (double newSampleRate, int numLevels, int firstAudibleLevel, bool enabled)
+{
+    sampleRate = newSampleRate;
+    maxLevel = enabled && settings.stepDownAbove > 0.0 ? juce::jmax (0, (settings.allowAudibleLevels ? numLevels : firstAudibleLevel) - 1) : 0;
+    average = secondsSinceChange = secondsUnder = secondsOver = 0.0;
+    level = 0;
+    usage = 0.f;
+}
+
+void QualityScheduler::endBlock (juce::int64 startTicks, int numSamples) noexcept
+{
+    if (maxLevel == 0 || numSamples <= 0)
+        return;
+
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    const auto budget = numSamples / sampleRate;
+    const auto used = elapsed / budget;
+
+    // A moving average over averagingSeconds whatever the block size.
+    const auto weight = 1.0 - std::exp (-budget / settings.averagingSeconds);
+    average += weight * (used - average);
+    usage.store ((float) average, std::memory_order_relaxed);
+
+    secondsSinceChange += budget;
+    secondsUnder = average < settings.stepUpBelow ? secondsUnder + budget : 0.0;
+    secondsOver = used >= 1.0 ? secondsOver + budget : 0.0;
+
+    const auto current = getLevel();
+
+    if (current < maxLevel && (secondsOver >= settings.overrunSeconds
+                                || (average > settings.stepDownAbove && secondsSinceChange >= settings.holdSeconds)))
+        setLevel (current + 1);
+    else if (current > 0 && secondsUnder >= settings.recoverSeconds)
+        setLevel (current - 1);
+}
+
+void QualityScheduler::setLevel (int newLevel) noexcept
+{
+    level.store (newLevel, std::memory_order_relaxed);
+    secondsSinceChange = secondsUnder = secondsOver = 0.0;
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    QualityScheduler.h
+
+    Watches how much of each block's deadline processBlock uses, and trades
+    quality for time when the machine can't keep up. The budget for a block
+    is its length in real time; usage is the time processBlock took over
+    that, averaged over a fraction of a second.
+
+    Past stepDownAbove the level goes up one (worse) step, and again after
+    holdSeconds if that wasn't enough. Blocks that keep overrunning their
+    whole budget for overrunSeconds step down without waiting out the hold,
+    still one step at a time; a single late block, which a page fault or a
+    busy host can cause, doesn't. It only comes back a step once usage has
+    stayed under stepUpBelow for recoverSeconds, so that it doesn't flap
+    between two levels.
+
+    What each level costs is up to the caller; this just counts them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class QualityScheduler
+{
+public:
+    struct Settings
+    {
+        /** Fractions of the block's budget. Zero or less turns it off. */
+        double stepDownAbove = 0.5;
+        double stepUpBelow = 0.2;
+
+        double averagingSeconds = 0.25;
+        double holdSeconds = 0.5;
+        double overrunSeconds = 0.1;
+        double recoverSeconds = 3.0;
+
+        /** Whether the caller's levels that change the sound may be used.
+            Off by default, leaving only the ones below firstAudibleLevel.
+        */
+        bool allowAudibleLevels = false;
+
+        /** Reads "<down>,<up>[,audible]" (e.g. "0.5,0.2" or "0.5,0.2,audible")
+            over the defaults; "0" or "off" turns it off.
+        */
+        static Settings fromString (const juce::String& text);
+    };
+
+    /** Call before prepare(). */
+    void setSettings (const Settings& newSettings) noexcept   { settings = newSettings; }
+    const Settings& getSettings() const noexcept             { return settings; }
+
+    /** Back to full quality. With enabled false, the level stays there.
+        Levels from firstAudibleLevel on are only used if the settings
+        allow them.
+    */
+    void prepare (double sampleRate, int numLevels, int firstAudibleLevel, bool enabled);
+
+    //==============================================================================
+    // Audio thread only.
+    static juce::int64 startBlock() noexcept   { return juce::Time::getHighResolutionTicks(); }
+    void endBlock (juce::int64 startTicks, int numSamples) noexcept;
+
+    //==============================================================================
+    // Any thread.
+    /** 0 is full quality, higher is cheaper. */
+    int getLevel() const noexcept              { return level.load (std::memory_order_relaxed); }
+
+    /** The averaged share of the budget processBlock is using, 1 being all of it. */
+    float getBudgetUsage() const noexcept      { return usage.load (std::memory_order_relaxed); }
+
+private:
+    void setLevel (int newLevel) noexcept;
+
+    Settings settings;
+    double sampleRate = 44100.0;
+    int maxLevel = 0;
+
+    // Audio thread only.
+    double average = 0.0, secondsSinceChange = 0.0, secondsUnder = 0.0, secondsOver = 0.0;
+
+    std::atomic<int> level { 0 };
+    std::atomic<float> usage { 0.f };
+};
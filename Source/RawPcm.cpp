@@ -0,0 +1,355 @@
+/*
+  ==============================================================================
+
+    RawPcm.cpp
+
+  ==============================================================================
+*/
+
+#include "RawPcm.h"
+
+#if JUCE_WINDOWS
+ #include <io.h>
+ #include <fcntl.h>
+#else
+ #include <fcntl.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+#if JUCE_LINUX
+ #include <sys/uio.h>
+#endif
+
+namespace RawPcm
+{
+
+int Format::getBytesPerSample() const noexcept
+{
+    switch (encoding)
+    {
+        case Encoding::s16:  return 2;
+        case Encoding::s24:  return 3;
+        case Encoding::s32:
+        case Encoding::f32:  return 4;
+    }
+
+    return 4;
+}
+
+bool Format::parseEncoding (const juce::String& name, Encoding& result)
+{
+    const std::pair<const char*, Encoding> names[] { { "s16", Encoding::s16 }, { "s24", Encoding::s24 },
+                                                     { "s32", Encoding::s32 }, { "f32", Encoding::f32 } };
+
+    for (const auto& entry : names)
+    {
+        if (name.trim().equalsIgnoreCase (entry.first))
+        {
+            result = entry.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//==============================================================================
+namespace
+{
+    struct S16
+    {
+        static constexpr int numBytes = 2;
+
+        static float read (const char* source) noexcept
+        {
+            return (float) (juce::int16) juce::ByteOrder::littleEndianShort (source) * (1.0f / 32768.0f);
+        }
+
+        static void write (float sample, char* destination) noexcept
+        {
+            const auto value = (juce::uint16) (juce::int16) juce::jmin (32767, juce::roundToInt (juce::jlimit (-1.0f, 1.0f, sample) * 32768.0f));
+            const auto bytes = juce::ByteOrder::swapIfBigEndian (value);
+            std::memcpy (destination, &bytes, sizeof (bytes));
+        }
+    };
+
+    struct S24
+    {
+        static constexpr int numBytes = 3;
+
+        static float read (const char* source) noexcept
+        {
+            return (float) juce::ByteOrder::littleEndian24Bit (source) * (1.0f / 8388608.0f);
+        }
+
+        static void write (float sample, char* destination) noexcept
+        {
+            const auto value = juce::jmin (8388607, juce::roundToInt (juce::jlimit (-1.0f, 1.0f, sample) * 8388608.0f));
+            juce::ByteOrder::littleEndian24BitToChars (value, destination);
+        }
+    };
+
+    struct S32
+    {
+        static constexpr int numBytes = 4;
+
+        static float read (const char* source) noexcept
+        {
+            return (float) ((double) (juce::int32) juce::ByteOrder::littleEndianInt (source) * (1.0 / 2147483648.0));
+        }
+
+        static void write (float sample, char* destination) noexcept
+        {
+            // In double, since a float can't hold the top of the range.
+            const auto scaled = std::round (juce::jlimit (-1.0, 1.0, (double) sample) * 2147483648.0);
+            const auto value = (juce::uint32) (juce::int32) juce::jmin (2147483647.0, scaled);
+            const auto bytes = juce::ByteOrder::swapIfBigEndian (value);
+            std::memcpy (destination, &bytes, sizeof (bytes));
+        }
+    };
+
+    struct F32
+    {
+        static constexpr int numBytes = 4;
+
+        static float read (const char* source) noexcept
+        {
+            const auto bits = juce::ByteOrder::littleEndianInt (source);
+            float sample;
+            std::memcpy (&sample, &bits, sizeof (sample));
+            return sample;
+        }
+
+        static void write (float sample, char* destination) noexcept
+        {
+            juce::uint32 bits;
+            std::memcpy (&bits, &sample, sizeof (bits));
+            bits = juce::ByteOrder::swapIfBigEndian (bits);
+            std::memcpy (destination, &bits, sizeof (bits));
+        }
+    };
+
+    template <typename Sample>
+    void deinterleaveAs (const char* source, float* const* channels, int numChannels, int numFrames) noexcept
+    {
+        for (int i = 0; i < numFrames; ++i)
+            for (int ch = 0; ch < numChannels; ++ch, source += Sample::numBytes)
+                channels[ch][i] = Sample::read (source);
+    }
+
+    template <typename Sample>
+    void interleaveAs (const float* const* channels, int numChannels, int numFrames, char* destination) noexcept
+    {
+        for (int i = 0; i < numFrames; ++i)
+            for (int ch = 0; ch < numChannels; ++ch, destination += Sample::numBytes)
+                Sample::write (channels[ch][i], destination);
+    }
+}
+
+void deinterleave (const Format& format, const char* source, juce::AudioBuffer<float>& destination, int numFrames) noexcept
+{
+    jassert (destination.getNumChannels() == format.numChannels && destination.getNumSamples() >= numFrames);
+    auto* const* channels = destination.getArrayOfWritePointers();
+
+    switch (format.encoding)
+    {
+        case Encoding::s16:  deinterleaveAs<S16> (source, channels, format.numChannels, numFrames); break;
+        case Encoding::s24:  deinterleaveAs<S24> (source, channels, format.numChannels, numFrames); break;
+        case Encoding::s32:  deinterleaveAs<S32> (source, channels, format.numChannels, numFrames); break;
+        case Encoding::f32:  deinterleaveAs<F32> (source, channels, format.numChannels, numFrames); break;
+    }
+}
+
+void interleave (const Format& format, const juce::AudioBuffer<float>& source, int numFrames, char* destination) noexcept
+{
+    jassert (source.getNumChannels() == format.numChannels && source.getNumSamples() >= numFrames);
+    const auto* const* channels = source.getArrayOfReadPointers();
+
+    switch (format.encoding)
+    {
+        case Encoding::s16:  interleaveAs<S16> (channels, format.numChannels, numFrames, destination); break;
+        case Encoding::s24:  interleaveAs<S24> (channels, format.numChannels, numFrames, destination); break;
+        case Encoding::s32:  interleaveAs<S32> (channels, format.numChannels, numFrames, destination); break;
+        case Encoding::f32:  interleaveAs<F32> (channels, format.numChannels, numFrames, destination); break;
+    }
+}
+
+//==============================================================================
+/** Puts the descriptor in binary mode where that's a thing, and grows it to
+    pipeSize if it's a pipe. Returns the pipe's size, or 0 if it isn't one
+    (or that can't be told).
+*/
+static int prepareDescriptor (int fd)
+{
+   #if JUCE_WINDOWS
+    _setmode (fd, _O_BINARY);
+    return 0;
+   #elif JUCE_LINUX
+    struct stat info;
+
+    if (fstat (fd, &info) != 0 || ! S_ISFIFO (info.st_mode))
+        return 0;
+
+    // Fails without privileges above /proc/sys/fs/pipe-max-size, leaving the
+    // pipe at the size it was.
+    if (fcntl (fd, F_GETPIPE_SZ) < pipeSize)
+        fcntl (fd, F_SETPIPE_SZ, pipeSize);
+
+    return juce::jmax (0, fcntl (fd, F_GETPIPE_SZ));
+   #else
+    juce::ignoreUnused (fd);
+    return 0;
+   #endif
+}
+
+static int readSome (int fd, char* data, int numBytes)
+{
+   #if JUCE_WINDOWS
+    return _read (fd, data, (unsigned int) numBytes);
+   #else
+    return (int) ::read (fd, data, (size_t) numBytes);
+   #endif
+}
+
+static int writeSome (int fd, const char* data, int numBytes)
+{
+   #if JUCE_WINDOWS
+    return _write (fd, data, (unsigned int) numBytes);
+   #else
+    return (int) ::write (fd, data, (size_t) numBytes);
+   #endif
+}
+
+//==============================================================================
+Input::Input (int fileDescriptor, const Format& formatToUse, int maxFrames)
+    : fd (fileDescriptor), format (formatToUse),
+      buffer ((size_t) (maxFrames * formatToUse.getBytesPerFrame())),
+      bufferSize (maxFrames * formatToUse.getBytesPerFrame())
+{
+    prepareDescriptor (fd);
+}
+
+int Input::read (juce::AudioBuffer<float>& chunk)
+{
+    const auto frameBytes = format.getBytesPerFrame();
+
+    // One read() takes whatever the pipe holds, so with a fast writer the
+    // chunks come out full, and with a slow one they go on without waiting.
+    while (numPending < frameBytes)
+    {
+        const auto numRead = readSome (fd, buffer + numPending, bufferSize - numPending);
+
+        if (numRead == 0)
+            return 0;
+
+        if (numRead < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return -1;
+        }
+
+        numPending += numRead;
+        numBytesRead += numRead;
+    }
+
+    const auto numFrames = numPending / frameBytes;
+    const auto numUsed = numFrames * frameBytes;
+
+    deinterleave (format, buffer, chunk, numFrames);
+
+    numPending -= numUsed;
+    std::memmove (buffer, buffer + numUsed, (size_t) numPending);
+    return numFrames;
+}
+
+//==============================================================================
+Output::Output (int fileDescriptor, const Format& formatToUse, int maxFrames, bool zeroCopy)
+    : fd (fileDescriptor), format (formatToUse),
+      chunkBytes ((size_t) (maxFrames * formatToUse.getBytesPerFrame())),
+      ringSize (chunkBytes)
+{
+    const auto pipeBytes = (size_t) prepareDescriptor (fd);
+
+   #if JUCE_LINUX
+    // Between a chunk being spliced and any of its bytes being written over,
+    // the ring comes all the way round, less three chunks at most: the
+    // chunk itself, the gap a chunk that doesn't fit at the end leaves, and
+    // the chunk that lands on it. So at least a pipe's worth goes out after
+    // it first.
+    useSplice = zeroCopy && pipeBytes > 0;
+
+    if (useSplice)
+        ringSize = pipeBytes + 3 * chunkBytes;
+   #else
+    juce::ignoreUnused (zeroCopy, pipeBytes);
+   #endif
+
+    ring.malloc (ringSize);
+}
+
+bool Output::write (const juce::AudioBuffer<float>& chunk, int numFrames)
+{
+    const auto numBytes = (size_t) (numFrames * format.getBytesPerFrame());
+    jassert (numBytes <= chunkBytes);
+
+    if (ringPosition + numBytes > ringSize)
+        ringPosition = 0;
+
+    auto* data = ring + ringPosition;
+    interleave (format, chunk, numFrames, data);
+
+    if (useSplice)
+        ringPosition += numBytes;
+
+    return writeAll (data, (int) numBytes);
+}
+
+bool Output::writeAll (const char* data, int numBytes)
+{
+    while (numBytes > 0)
+    {
+       #if JUCE_LINUX
+        if (useSplice)
+        {
+            iovec part { const_cast<char*> (data), (size_t) numBytes };
+            const auto numSpliced = (int) vmsplice (fd, &part, 1, 0);
+
+            if (numSpliced >= 0)
+            {
+                data += numSpliced;
+                numBytes -= numSpliced;
+                continue;
+            }
+
+            if (errno == EINTR)
+                continue;
+
+            if (errno != EINVAL && errno != ENOSYS)
+                return false;
+
+            // Copying is always safe, so carry on that way.
+            useSplice = false;
+        }
+       #endif
+
+        const auto numWritten = writeSome (fd, data, numBytes);
+
+        if (numWritten < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        data += numWritten;
+        numBytes -= numWritten;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    RawPcm.h
+
+    Headerless interleaved PCM on file descriptors, for running the EQ as a
+    filter in a shell pipeline (sox ... | Vonic --render-raw | ffmpeg ...).
+    The format isn't in the stream, so it comes from the command line.
+
+    Converting to and from float is done in the same pass as splitting the
+    channels apart and back, so each sample is touched once on the way in
+    and once on the way out.
+
+    On Linux, pipes on either end are grown to pipeSize so that each
+    read() and write() moves more per call. With zero copy asked for, the
+    output goes out through vmsplice(), which hands the pipe references to
+    our own pages rather than copying them. That is only safe while the
+    pages are left alone until the reader has taken them, so Output cycles
+    through a ring of a pipe's worth plus three chunks: once a whole pipe's
+    worth has gone out after a buffer, that buffer must have been read.
+    This holds only if the reader copies the data out; a reader that
+    splices it onward keeps references past that point, which is why zero
+    copy is off by default.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace RawPcm
+{
+    enum class Encoding { s16, s24, s32, f32 };
+
+    struct Format
+    {
+        Encoding encoding = Encoding::s16;
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+
+        int getBytesPerSample() const noexcept;
+        int getBytesPerFrame() const noexcept   { return getBytesPerSample() * numChannels; }
+
+        /** "s16", "s24", "s32" or "f32", all little-endian. Returns false if
+            the name isn't one of them.
+        */
+        static bool parseEncoding (const juce::String& name, Encoding& result);
+    };
+
+    /** Splits numFrames interleaved frames into the first numFrames samples
+        of each of the buffer's channels, as floats from -1 to 1.
+    */
+    void deinterleave (const Format& format, const char* source, juce::AudioBuffer<float>& destination, int numFrames) noexcept;
+
+    /** The reverse of deinterleave(). Integer encodings are rounded to the
+        nearest step and clipped.
+    */
+    void interleave (const Format& format, const juce::AudioBuffer<float>& source, int numFrames, char* destination) noexcept;
+
+    constexpr int pipeSize = 1 << 20;
+
+    //==============================================================================
+    /** Reads whole frames from a file descriptor. */
+    class Input
+    {
+    public:
+        Input (int fileDescriptor, const Format& format, int maxFrames);
+
+        /** Waits for at least one frame and returns as many as have arrived,
+            up to maxFrames, converted into the chunk. Returns 0 at the end of
+            the input and -1 on failure.
+        */
+        int read (juce::AudioBuffer<float>& chunk);
+
+        /** Bytes left over at the end that didn't make up a whole frame. */
+        int getNumLeftoverBytes() const noexcept   { return numPending; }
+
+        juce::int64 getNumBytesRead() const noexcept   { return numBytesRead; }
+
+    private:
+        const int fd;
+        const Format format;
+        juce::HeapBlock<char> buffer;
+        int bufferSize, numPending = 0;
+        juce::int64 numBytesRead = 0;
+    };
+
+    //==============================================================================
+    /** Writes frames to a file descriptor, through vmsplice() when zero
+        copy is asked for and the descriptor is a pipe that accepts it.
+    */
+    class Output
+    {
+    public:
+        Output (int fileDescriptor, const Format& format, int maxFrames, bool zeroCopy);
+
+        /** Converts the first numFrames of the chunk and writes them,
+            returning false on failure.
+        */
+        bool write (const juce::AudioBuffer<float>& chunk, int numFrames);
+
+        bool isZeroCopy() const noexcept   { return useSplice; }
+
+    private:
+        bool writeAll (const char* data, int numBytes);
+
+        const int fd;
+        const Format format;
+        juce::HeapBlock<char> ring;
+        size_t chunkBytes, ringSize, ringPosition = 0;
+        bool useSplice = false;
+    };
+}
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.cpp
+
+  ==============================================================================
+*/
+
+#include "RenderPipeline.h"
+
+/** Chunk indices on their way from one stage to the next. Never holds more
+    than the pool, so pushing can't fail; popping waits.
+*/
+class RenderPipeline::ChunkQueue
+{
+public:
+    explicit ChunkQueue (int capacity)
+        : fifo (capacity + 1), slots ((size_t) capacity + 1)
+    {
+    }
+
+    void push (int index)
+    {
+        {
+            const auto scope = fifo.write (1);
+            jassert (scope.blockSize1 == 1);
+
+            if (scope.blockSize1 > 0)
+                slots[(size_t) scope.startIndex1] = index;
+        }
+
+        ready.signal();
+    }
+
+    /** Waits for the next chunk, returning false once the stage feeding this
+        queue has finished and it is empty, or as soon as anything fails.
+    */
+    bool pop (int& index, const std::atomic<bool>& producerFinished, const std::atomic<bool>& failed)
+    {
+        for (;;)
+        {
+            if (failed)
+                return false;
+
+            if (tryPop (index))
+                return true;
+
+            // Anything pushed before the flag was set is still there to take.
+            if (producerFinished)
+                return tryPop (index);
+
+            ready.wait (10);
+        }
+    }
+
+    void wake()   { ready.signal(); }
+
+private:
+    bool tryPop (int& index)
+    {
+        const auto scope = fifo.read (1);
+
+        if (scope.blockSize1 == 0)
+            return false;
+
+        index = slots[(size_t) scope.startIndex1];
+        return true;
+    }
+
+    juce::AbstractFifo fifo;
+    std::vector<int> slots;
+    juce::WaitableEvent ready;
+};
+
+class RenderPipeline::StageThread  : public juce::Thread
+{
+public:
+    StageThread (const juce::String& name, std::function<void()> body)
+        : juce::Thread (name), work (std::move (body))
+    {
+    }
+
+    void run() override   { work(); }
+
+private:
+    std::function<void()> work;
+};
+
+//==============================================================================
+juce::String RenderPipeline::Report::getBottleneck() const
+{
+    if (decodeUtilisation >= processUtilisation && decodeUtilisation >= encodeUtilisation)
+        return "decode";
+
+    return processUtilisation >= encodeUtilisation ? "filter" : "encode";
+}
+
+RenderPipeline::RenderPipeline (int numChannels, int chunkSize, int numChunks)
+    : chunkLengths ((size_t) juce::jmax (2, numChunks))
+{
+    for (size_t i = 0; i < chunkLengths.size(); ++i)
+        chunks.emplace_back (numChannels, chunkSize);
+}
+
+RenderPipeline::Report RenderPipeline::run (const Stages& stages)
+{
+    Report report;
+    const auto numChunks = (int) chunks.size();
+    ChunkQueue empty (numChunks), decoded (numChunks), processed (numChunks);
+    std::atomic<bool> decodeFinished { false }, processFinished { false }, failed { false }, never { false };
+    juce::int64 decodeTicks = 0, processTicks = 0, encodeTicks = 0;
+
+    // Only the first failure is reported; the others are knock-on effects.
+    const auto fail = [&] (const juce::String& stage)
+    {
+        if (! failed.exchange (true))
+            report.failedStage = stage;
+
+        empty.wake();
+        decoded.wake();
+        processed.wake();
+    };
+
+    // Times one call to a stage, leaving out the time spent waiting.
+    const auto timed = [] (juce::int64& total, auto&& call)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        const auto result = call();
+        total += juce::Time::getHighResolutionTicks() - start;
+        return result;
+    };
+
+    for (int i = 0; i < numChunks; ++i)
+        empty.push (i);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    StageThread decoder ("Vonic decode", [&]
+    {
+        for (int index = 0; empty.pop (index, never, failed);)
+        {
+            auto& chunk = chunks[(size_t) index];
+            const auto numSamples = timed (decodeTicks, [&] { return stages.decode (chunk); });
+
+            if (numSamples < 0)
+                fail ("decode");
+
+            if (numSamples <= 0)
+                break;
+
+            chunkLengths[(size_t) index] = numSamples;
+            decoded.push (index);
+        }
+
+        decodeFinished = true;
+        decoded.wake();
+    });
+
+    StageThread encoder ("Vonic encode", [&]
+    {
+        for (int index = 0; processed.pop (index, processFinished, failed);)
+        {
+            const auto& chunk = chunks[(size_t) index];
+
+            if (! timed (encodeTicks, [&] { return stages.encode (chunk, chunkLengths[(size_t) index]); }))
+            {
+                fail ("encode");
+                break;
+            }
+
+            empty.push (index);
+        }
+    });
+
+    decoder.startThread();
+    encoder.startThread();
+
+    for (int index = 0; decoded.pop (index, decodeFinished, failed);)
+    {
+        timed (processTicks, [&] { stages.process (chunks[(size_t) index], chunkLengths[(size_t) index]); return true; });
+        processed.push (index);
+        ++report.numChunks;
+    }
+
+    processFinished = true;
+    processed.wake();
+
+    decoder.waitForThreadToExit (-1);
+    encoder.waitForThreadToExit (-1);
+
+    const auto totalTicks = juce::jmax ((juce::int64) 1, juce::Time::getHighResolutionTicks() - startTicks);
+    report.seconds = juce::Time::highResolutionTicksToSeconds (totalTicks);
+    report.decodeUtilisation = (double) decodeTicks / (double) totalTicks;
+    report.processUtilisation = (double) processTicks / (double) totalTicks;
+    report.encodeUtilisation = (double) encodeTicks / (double) totalTicks;
+    return report;
+}
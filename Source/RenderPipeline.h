@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.h
+
+    Streams a file render through three threads: one decoding, one
+    filtering and one encoding, so that with a compressed format on either
+    end the codec work no longer waits on the filters or the other way
+    round.
+
+    The stages pass chunks along single-producer, single-consumer rings
+    (juce::AbstractFifo) of indices into a fixed pool of AudioBuffers. The
+    encoder hands each chunk back to the decoder once it has been written,
+    so nothing is allocated once the render has started, and the pool's
+    size is what bounds how far the decoder can run ahead.
+
+    Each stage's busy time is measured, so the report shows which of the
+    three is holding the others up.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class RenderPipeline
+{
+public:
+    struct Stages
+    {
+        /** Fills the chunk, returning the number of samples read: 0 at the
+            end, or less than 0 on failure.
+        */
+        std::function<int (juce::AudioBuffer<float>& chunk)> decode;
+
+        /** Filters the first numSamples of the chunk in place. Called on one
+            thread, in order.
+        */
+        std::function<void (juce::AudioBuffer<float>& chunk, int numSamples)> process;
+
+        /** Writes the first numSamples of the chunk, returning false on failure. */
+        std::function<bool (const juce::AudioBuffer<float>& chunk, int numSamples)> encode;
+    };
+
+    struct Report
+    {
+        double seconds = 0.0;
+        juce::int64 numChunks = 0;
+
+        /** The share of the render each stage spent working rather than
+            waiting for the others, 1 being all of it.
+        */
+        double decodeUtilisation = 0.0, processUtilisation = 0.0, encodeUtilisation = 0.0;
+
+        /** "decode" or "encode" if that stage failed, otherwise empty. */
+        juce::String failedStage;
+
+        /** "decode", "filter" or "encode". */
+        juce::String getBottleneck() const;
+    };
+
+    RenderPipeline (int numChannels, int chunkSize, int numChunks = 6);
+
+    /** Runs the stages until decode reports the end, or one of them fails.
+        process runs on the calling thread.
+    */
+    Report run (const Stages& stages);
+
+private:
+    class ChunkQueue;
+    class StageThread;
+
+    std::vector<juce::AudioBuffer<float>> chunks;
+    std::vector<int> chunkLengths;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderPipeline)
+};
@@ -0,0 +1,505 @@
+/*
+  ==============================================================================
+
+    SpectrumMatch.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumMatch.h"
+#include "FastDesign.h"
+
+namespace SpectrumMatch
+{
+
+static constexpr double lowestFrequency = 20.0, highestFrequency = 20000.0;
+
+static std::vector<double> getBandFrequencies (int bandsPerOctave)
+{
+    std::vector<double> frequencies;
+    const auto ratio = std::pow (2.0, 1.0 / bandsPerOctave);
+
+    for (auto f = lowestFrequency; f <= highestFrequency; f *= ratio)
+        frequencies.push_back (f);
+
+    return frequencies;
+}
+
+//==============================================================================
+struct BandLevels
+{
+    juce::String error;
+
+    /** Average power per band in dB, NaN where the file has nothing to say
+        (above its Nyquist, or too far down to trust).
+    */
+    std::vector<double> levels;
+
+    double sampleRate = 0.0, seconds = 0.0;
+};
+
+static BandLevels analyseFile (const juce::File& file, const std::vector<double>& bands, const Options& options)
+{
+    BandLevels result;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr)
+    {
+        result.error = "Couldn't read " + file.getFullPathName();
+        return result;
+    }
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto length = reader->lengthInSamples;
+    const auto sampleRate = reader->sampleRate;
+    result.sampleRate = sampleRate;
+    result.seconds = (double) length / sampleRate;
+
+    const auto fftSize = 1 << options.fftOrder;
+    const auto hop = fftSize / 2;
+    const auto chunkSize = 64 * hop;
+
+    juce::dsp::FFT fft (options.fftOrder);
+    juce::dsp::WindowingFunction<float> window ((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+    std::vector<float> frame ((size_t) fftSize * 2);
+    std::vector<double> power ((size_t) fftSize / 2 + 1, 0.0);
+    juce::int64 numFrames = 0;
+
+    // Power is summed per channel rather than on a mono mix, so that content
+    // which cancels between channels still counts.
+    auto addFrame = [&] (const juce::AudioBuffer<float>& buffer, int start)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            std::fill (frame.begin(), frame.end(), 0.f);
+            std::copy (buffer.getReadPointer (ch, start), buffer.getReadPointer (ch, start) + fftSize, frame.begin());
+            window.multiplyWithWindowingTable (frame.data(), (size_t) fftSize);
+            fft.performFrequencyOnlyForwardTransform (frame.data(), true);
+
+            for (size_t k = 0; k < power.size(); ++k)
+                power[k] += (double) frame[k] * (double) frame[k];
+        }
+
+        ++numFrames;
+    };
+
+    // Each chunk is appended after whatever the previous one left over, so
+    // every sample is read from the file exactly once.
+    juce::AudioBuffer<float> buffer (numChannels, fftSize + chunkSize);
+    int numBuffered = 0;
+
+    for (juce::int64 position = 0; position < length;)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) chunkSize, length - position);
+        reader->read (&buffer, numBuffered, numSamples, position, true, true);
+        position += numSamples;
+        numBuffered += numSamples;
+
+        int start = 0;
+
+        for (; start + fftSize <= numBuffered; start += hop)
+            addFrame (buffer, start);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::memmove (buffer.getWritePointer (ch), buffer.getReadPointer (ch, start), sizeof (float) * (size_t) (numBuffered - start));
+
+        numBuffered -= start;
+    }
+
+    // Anything shorter than one frame still gets measured, zero padded.
+    if (numFrames == 0 && numBuffered > 0)
+    {
+        buffer.clear (numBuffered, fftSize - numBuffered);
+        addFrame (buffer, 0);
+    }
+
+    if (numFrames == 0)
+    {
+        result.error = file.getFileName() + " is empty";
+        return result;
+    }
+
+    const auto binWidth = sampleRate / fftSize;
+    const auto halfBand = std::pow (2.0, 0.5 / options.bandsPerOctave);
+    double loudest = -400.0;
+
+    result.levels.resize (bands.size(), std::numeric_limits<double>::quiet_NaN());
+
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        if (bands[b] > sampleRate * 0.45)
+            break;
+
+        // Low bands can be narrower than a bin; they fall back on the nearest one.
+        const auto first = juce::jmax (1, (int) std::ceil (bands[b] / halfBand / binWidth));
+        const auto last = juce::jmax (first, (int) std::floor (bands[b] * halfBand / binWidth));
+        double sum = 0.0;
+
+        for (auto k = first; k <= last; ++k)
+            sum += power[(size_t) juce::jmin (k, (int) power.size() - 1)];
+
+        const auto level = 10.0 * std::log10 (juce::jmax (sum / (double) ((last - first + 1) * numFrames), 1.0e-40));
+        result.levels[b] = level;
+        loudest = juce::jmax (loudest, level);
+    }
+
+    // Bands that are nowhere near the rest are noise floor or nothing at all,
+    // and boosting them would only bring up hiss.
+    for (auto& level : result.levels)
+        if (level < loudest - 90.0)
+            level = std::numeric_limits<double>::quiet_NaN();
+
+    return result;
+}
+
+//==============================================================================
+// The continuous settings, with frequencies and Q on a log scale so that a
+// step means the same thing anywhere in their range.
+using Parameters = std::array<double, 5>;
+enum { lowCutIndex, highCutIndex, peakIndex, gainIndex, qIndex };
+
+static void clampParameters (Parameters& p)
+{
+    const auto logLow = std::log (lowestFrequency), logHigh = std::log (highestFrequency);
+    p[lowCutIndex] = juce::jlimit (logLow, logHigh, p[lowCutIndex]);
+    p[highCutIndex] = juce::jlimit (logLow, logHigh, p[highCutIndex]);
+    p[peakIndex] = juce::jlimit (logLow, logHigh, p[peakIndex]);
+    p[gainIndex] = juce::jlimit (-24.0, 24.0, p[gainIndex]);
+    p[qIndex] = juce::jlimit (std::log (0.1), std::log (10.0), p[qIndex]);
+}
+
+static FilterSet toFilterSet (const Parameters& p, Gradient lowCutSlope, Gradient highCutSlope)
+{
+    FilterSet settings;
+    settings.lowCutFreq = (float) std::exp (p[lowCutIndex]);
+    settings.highCutFreq = (float) std::exp (p[highCutIndex]);
+    settings.peakFreq = (float) std::exp (p[peakIndex]);
+    settings.peakGain = (float) p[gainIndex];
+    settings.peakQual = (float) std::exp (p[qIndex]);
+    settings.lowCutSlope = lowCutSlope;
+    settings.highCutSlope = highCutSlope;
+    return settings;
+}
+
+struct Problem
+{
+    const std::vector<double>& frequencies;
+    const std::vector<double>& targetDb;
+    const std::vector<double>& weights;
+    double sampleRate;
+
+    /** Fills in the weighted residuals and returns their sum of squares. */
+    double evaluate (const FilterSet& settings, std::vector<double>& residuals) const
+    {
+        // The fit calls this thousands of times; the fast designer matches
+        // the exact one far more closely than the fit needs.
+        const auto chain = FastDesign::designChain (settings, sampleRate);
+        double cost = 0.0;
+
+        residuals.resize (frequencies.size());
+
+        for (size_t k = 0; k < frequencies.size(); ++k)
+        {
+            residuals[k] = weights[k] > 0.0 ? std::sqrt (weights[k]) * (getResponseDb (chain, frequencies[k], sampleRate) - targetDb[k])
+                                            : 0.0;
+            cost += residuals[k] * residuals[k];
+        }
+
+        return cost;
+    }
+};
+
+/** Solves the 5x5 system a.x = b in place by Gaussian elimination. */
+static bool solve (std::array<std::array<double, 5>, 5> a, std::array<double, 5>& b)
+{
+    constexpr int n = 5;
+
+    for (int col = 0; col < n; ++col)
+    {
+        auto pivot = col;
+
+        for (int row = col + 1; row < n; ++row)
+            if (std::abs (a[(size_t) row][(size_t) col]) > std::abs (a[(size_t) pivot][(size_t) col]))
+                pivot = row;
+
+        if (std::abs (a[(size_t) pivot][(size_t) col]) < 1.0e-300)
+            return false;
+
+        std::swap (a[(size_t) col], a[(size_t) pivot]);
+        std::swap (b[(size_t) col], b[(size_t) pivot]);
+
+        for (int row = col + 1; row < n; ++row)
+        {
+            const auto factor = a[(size_t) row][(size_t) col] / a[(size_t) col][(size_t) col];
+
+            for (int k = col; k < n; ++k)
+                a[(size_t) row][(size_t) k] -= factor * a[(size_t) col][(size_t) k];
+
+            b[(size_t) row] -= factor * b[(size_t) col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; --row)
+    {
+        for (int k = row + 1; k < n; ++k)
+            b[(size_t) row] -= a[(size_t) row][(size_t) k] * b[(size_t) k];
+
+        b[(size_t) row] /= a[(size_t) row][(size_t) row];
+    }
+
+    return true;
+}
+
+/** Levenberg-Marquardt from the given start, with forward-difference
+    derivatives. Returns the final cost and leaves the answer in p.
+*/
+static double refine (const Problem& problem, Parameters& p, Gradient lowCutSlope, Gradient highCutSlope)
+{
+    static constexpr Parameters steps { 1.0e-3, 1.0e-3, 1.0e-3, 1.0e-2, 1.0e-3 };
+
+    std::vector<double> residuals, trialResiduals;
+    std::array<std::vector<double>, 5> jacobian;
+    auto cost = problem.evaluate (toFilterSet (p, lowCutSlope, highCutSlope), residuals);
+    auto lambda = 1.0e-2;
+
+    for (int iteration = 0; iteration < 50; ++iteration)
+    {
+        for (size_t j = 0; j < p.size(); ++j)
+        {
+            auto shifted = p;
+            shifted[j] += steps[j];
+            problem.evaluate (toFilterSet (shifted, lowCutSlope, highCutSlope), jacobian[j]);
+
+            for (size_t k = 0; k < residuals.size(); ++k)
+                jacobian[j][k] = (jacobian[j][k] - residuals[k]) / steps[j];
+        }
+
+        std::array<std::array<double, 5>, 5> normal {};
+        Parameters gradient {};
+
+        for (size_t i = 0; i < p.size(); ++i)
+        {
+            for (size_t k = 0; k < residuals.size(); ++k)
+                gradient[i] -= jacobian[i][k] * residuals[k];
+
+            for (size_t j = 0; j < p.size(); ++j)
+                for (size_t k = 0; k < residuals.size(); ++k)
+                    normal[i][j] += jacobian[i][k] * jacobian[j][k];
+        }
+
+        auto improved = false;
+
+        for (int attempt = 0; attempt < 10 && ! improved; ++attempt)
+        {
+            // A parameter pinned against its limit has no gradient at all;
+            // the small constant keeps the system solvable anyway.
+            auto damped = normal;
+
+            for (size_t i = 0; i < p.size(); ++i)
+                damped[i][i] += lambda * normal[i][i] + 1.0e-9;
+
+            auto step = gradient;
+
+            if (solve (damped, step))
+            {
+                auto trial = p;
+
+                for (size_t i = 0; i < p.size(); ++i)
+                    trial[i] += step[i];
+
+                clampParameters (trial);
+                const auto trialCost = problem.evaluate (toFilterSet (trial, lowCutSlope, highCutSlope), trialResiduals);
+
+                if (trialCost < cost)
+                {
+                    improved = cost - trialCost > cost * 1.0e-9;
+                    p = trial;
+                    cost = trialCost;
+                    std::swap (residuals, trialResiduals);
+                    lambda = juce::jmax (1.0e-7, lambda * 0.3);
+
+                    if (! improved)
+                        return cost;
+
+                    break;
+                }
+            }
+
+            lambda *= 10.0;
+        }
+
+        if (! improved)
+            break;
+    }
+
+    return cost;
+}
+
+FilterSet fit (const std::vector<double>& frequencies, const std::vector<double>& targetDb,
+               const std::vector<double>& weights, double sampleRate, double& rmsErrorDb)
+{
+    const Problem problem { frequencies, targetDb, weights, sampleRate };
+    std::vector<double> residuals;
+
+    // Start the peak on the biggest difference in the target, and each cut on
+    // whichever frequency explains the target best by itself.
+    Parameters start { std::log (lowestFrequency), std::log (highestFrequency), std::log (1000.0), 0.0, 0.0 };
+    double largest = 0.0;
+
+    for (size_t k = 0; k < frequencies.size(); ++k)
+    {
+        if (weights[k] > 0.0 && frequencies[k] >= 40.0 && frequencies[k] <= 16000.0 && std::abs (targetDb[k]) > largest)
+        {
+            largest = std::abs (targetDb[k]);
+            start[peakIndex] = std::log (frequencies[k]);
+            start[gainIndex] = juce::jlimit (-24.0, 24.0, targetDb[k]);
+        }
+    }
+
+    for (auto index : { lowCutIndex, highCutIndex })
+    {
+        auto best = problem.evaluate (toFilterSet (start, grad24, grad24), residuals);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            auto candidate = start;
+            candidate[(size_t) index] = std::log (lowestFrequency) + (std::log (highestFrequency) - std::log (lowestFrequency)) * i / 15.0;
+            const auto cost = problem.evaluate (toFilterSet (candidate, grad24, grad24), residuals);
+
+            if (cost < best)
+            {
+                best = cost;
+                start[(size_t) index] = candidate[(size_t) index];
+            }
+        }
+    }
+
+    // The slopes are discrete, so every combination gets its own refinement.
+    // Only the 12 dB steps up to 48 are tried: finer or steeper ones cost
+    // far more refinements than they ever improve a tonal-balance match.
+    FilterSet bestSettings = toFilterSet (start, grad12, grad12);
+    auto bestCost = std::numeric_limits<double>::max();
+
+    for (int low = grad12; low <= grad48; low += grad24 - grad12)
+    {
+        for (int high = grad12; high <= grad48; high += grad24 - grad12)
+        {
+            auto p = start;
+            const auto cost = refine (problem, p, (Gradient) low, (Gradient) high);
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSettings = toFilterSet (p, (Gradient) low, (Gradient) high);
+            }
+        }
+    }
+
+    double totalWeight = 0.0;
+
+    for (auto w : weights)
+        totalWeight += w;
+
+    rmsErrorDb = totalWeight > 0.0 ? std::sqrt (bestCost / totalWeight) : 0.0;
+    return bestSettings;
+}
+
+//==============================================================================
+Result match (const juce::File& source, const juce::Array<juce::File>& references, const Options& options)
+{
+    Result result;
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const auto bands = getBandFrequencies (options.bandsPerOctave);
+
+    juce::Array<juce::File> files;
+    files.add (source);
+    files.addArray (references);
+
+    std::vector<BandLevels> levels ((size_t) files.size());
+    {
+        std::atomic<int> remaining { files.size() };
+        juce::WaitableEvent finished;
+        juce::ThreadPool pool (juce::jmax (1, juce::jmin (options.numThreads, files.size())));
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            pool.addJob ([&, i]
+            {
+                levels[(size_t) i] = analyseFile (files.getReference (i), bands, options);
+
+                if (--remaining == 0)
+                    finished.signal();
+            });
+        }
+
+        finished.wait (-1);
+    }
+
+    for (auto& file : levels)
+    {
+        if (file.error.isNotEmpty())
+        {
+            result.error = file.error;
+            return result;
+        }
+
+        result.audioSeconds += file.seconds;
+    }
+
+    // References are averaged as power, band by band, over the files that
+    // actually cover each band.
+    std::vector<double> targetDb (bands.size(), 0.0), weights (bands.size(), 0.0);
+
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        const auto sourceLevel = levels[0].levels[b];
+        double sum = 0.0;
+        int count = 0;
+
+        for (size_t i = 1; i < levels.size(); ++i)
+        {
+            if (! std::isnan (levels[i].levels[b]))
+            {
+                sum += std::pow (10.0, levels[i].levels[b] / 10.0);
+                ++count;
+            }
+        }
+
+        if (count > 0 && ! std::isnan (sourceLevel))
+        {
+            targetDb[b] = 10.0 * std::log10 (sum / count) - sourceLevel;
+            weights[b] = 1.0;
+        }
+    }
+
+    // Only the shape matters: line the curves up on their midrange level.
+    double offset = 0.0, offsetWeight = 0.0;
+
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        if (bands[b] >= 200.0 && bands[b] <= 5000.0)
+        {
+            offset += weights[b] * targetDb[b];
+            offsetWeight += weights[b];
+        }
+    }
+
+    if (offsetWeight == 0.0)
+    {
+        result.error = "The files have no midrange content in common to match";
+        return result;
+    }
+
+    for (auto& target : targetDb)
+        target = juce::jlimit (-24.0, 24.0, target - offset / offsetWeight);
+
+    result.settings = fit (bands, targetDb, weights, levels[0].sampleRate, result.rmsErrorDb);
+    result.analysisSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    return result;
+}
+
+} // namespace SpectrumMatch
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SpectrumMatch.h
+
+    Offline auto-EQ. Long-term average spectra of a source and of one or more
+    references are measured with a streaming FFT, reduced to fractional
+    octave bands, and the low-cut, peak and high-cut settings are fitted to
+    the difference between them with Levenberg-Marquardt.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainDesign.h"
+
+namespace SpectrumMatch
+{
+    struct Options
+    {
+        /** FFT size is 1 << fftOrder; frames overlap by half. */
+        int fftOrder = 13;
+
+        /** Resolution of the curve that gets fitted. */
+        int bandsPerOctave = 6;
+
+        /** Files are analysed in parallel, one per thread. */
+        int numThreads = juce::SystemStats::getNumCpus();
+    };
+
+    struct Result
+    {
+        /** Non-empty if any file couldn't be analysed; nothing else is set then. */
+        juce::String error;
+
+        FilterSet settings;
+
+        /** Weighted RMS distance between the fitted EQ and the target curve. */
+        double rmsErrorDb = 0.0;
+
+        /** Total length of all the files analysed, and how long it took. */
+        double audioSeconds = 0.0, analysisSeconds = 0.0;
+    };
+
+    /** Finds the settings that bring source closest to the average tonal
+        balance of the references. Overall level differences are ignored,
+        since the EQ has no output gain to correct them with.
+    */
+    Result match (const juce::File& source, const juce::Array<juce::File>& references, const Options& options);
+
+    /** Fits the EQ to a target response given in dB at each frequency. Bands
+        with zero weight are ignored. Exposed separately for callers that
+        already have a target curve.
+    */
+    FilterSet fit (const std::vector<double>& frequencies, const std::vector<double>& targetDb,
+                   const std::vector<double>& weights, double sampleRate, double& rmsErrorDb);
+}
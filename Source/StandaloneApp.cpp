@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    StandaloneApp.cpp
+
+    Our own copy of JUCE's StandaloneFilterApp (enabled through
+    JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP), so that the standalone build can
+    also run the headless tools in CommandLine.cpp.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#if JucePlugin_Build_Standalone && JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP
+
+#include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#include "CommandLine.h"
+#include "LiveAudio.h"
+
+class VonicStandaloneApp  : public juce::JUCEApplication
+{
+public:
+    VonicStandaloneApp()
+    {
+        juce::PropertiesFile::Options options;
+
+        options.applicationName     = getApplicationName();
+        options.filenameSuffix      = ".settings";
+        options.osxLibrarySubFolder = "Application Support";
+       #if JUCE_LINUX || JUCE_BSD
+        options.folderName          = "~/.config";
+       #else
+        options.folderName          = "";
+       #endif
+
+        appProperties.setStorageParameters (options);
+    }
+
+    const juce::String getApplicationName() override              { return JucePlugin_Name; }
+    const juce::String getApplicationVersion() override           { return JucePlugin_VersionString; }
+    bool moreThanOneInstanceAllowed() override                    { return true; }
+    void anotherInstanceStarted (const juce::String&) override    {}
+
+    void initialise (const juce::String&) override
+    {
+        int exitCode = 0;
+
+        if (runCommandLine (getCommandLineParameterArray(), exitCode))
+        {
+            setApplicationReturnValue (exitCode);
+            quit();
+            return;
+        }
+
+        mainWindow.reset (createWindow());
+        mainWindow->setVisible (true);
+
+        const auto liveOptions = LiveAudio::Options::parse ({ getApplicationName(), getCommandLineParameterArray() });
+
+        if (liveOptions.isEnabled())
+            liveAudio = std::make_unique<LiveAudio> (mainWindow->pluginHolder->deviceManager, liveOptions);
+    }
+
+    void shutdown() override
+    {
+        liveAudio = nullptr;
+        mainWindow = nullptr;
+        appProperties.saveIfNeeded();
+    }
+
+    void systemRequestedQuit() override
+    {
+        if (mainWindow != nullptr)
+            mainWindow->pluginHolder->savePluginState();
+
+        if (juce::ModalComponentManager::getInstance()->cancelAllModalComponents())
+        {
+            juce::Timer::callAfterDelay (100, []()
+            {
+                if (auto app = juce::JUCEApplicationBase::getInstance())
+                    app->systemRequestedQuit();
+            });
+        }
+        else
+        {
+            quit();
+        }
+    }
+
+private:
+    juce::StandaloneFilterWindow* createWindow()
+    {
+        return new juce::StandaloneFilterWindow (getApplicationName(),
+                                                 juce::LookAndFeel::getDefaultLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId),
+                                                 appProperties.getUserSettings(),
+                                                 false, {}, nullptr, {});
+    }
+
+    juce::ApplicationProperties appProperties;
+    std::unique_ptr<juce::StandaloneFilterWindow> mainWindow;
+    std::unique_ptr<LiveAudio> liveAudio;
+};
+
+juce::JUCEApplicationBase* juce_CreateApplication();
+juce::JUCEApplicationBase* juce_CreateApplication() { return new VonicStandaloneApp(); }
+
+#endif
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    Telemetry.cpp
+
+  ==============================================================================
+*/
+
+#include "Telemetry.h"
+
+#if VONIC_TELEMETRY
+
+Telemetry::Telemetry()
+{
+    for (auto& bucket : histogram)
+        bucket.store (0, std::memory_order_relaxed);
+}
+
+int Telemetry::getBucket (juce::uint32 nanos) noexcept
+{
+    if (nanos < bucketsPerOctave)
+        return (int) nanos;
+
+    // Octave from the top bit, quarter-octave from the two bits below it.
+    const auto octave = juce::findHighestSetBit (nanos);
+    const auto quarter = (int) (nanos >> (octave - 2)) & (bucketsPerOctave - 1);
+    return juce::jmin (numBuckets - 1, octave * bucketsPerOctave + quarter);
+}
+
+double Telemetry::getBucketUpperMicros (int bucket) noexcept
+{
+    if (bucket < bucketsPerOctave)
+        return (bucket + 1) * 0.001;
+
+    const auto octave = bucket / bucketsPerOctave;
+    const auto quarter = bucket % bucketsPerOctave;
+    return (double) ((juce::uint64) (bucketsPerOctave + quarter + 1) << (octave - 2)) * 0.001;
+}
+
+void Telemetry::endBlock (juce::int64 startTicks) noexcept
+{
+    const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    const auto nanos = (juce::uint32) juce::jlimit (0.0, 4.0e9, seconds * 1.0e9);
+
+    auto& bucket = histogram[(size_t) getBucket (nanos)];
+    bucket.store (bucket.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    increment (numBlocks);
+    totalNanos.store (totalNanos.load (std::memory_order_relaxed) + nanos, std::memory_order_relaxed);
+
+    if (nanos < minNanos.load (std::memory_order_relaxed))
+        minNanos.store (nanos, std::memory_order_relaxed);
+
+    if (nanos > maxNanos.load (std::memory_order_relaxed))
+        maxNanos.store (nanos, std::memory_order_relaxed);
+}
+
+Telemetry::Snapshot Telemetry::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    snapshot.timeSeconds = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    snapshot.numBlocks = numBlocks.load (std::memory_order_relaxed);
+    snapshot.numRedesigns = numRedesigns.load (std::memory_order_relaxed);
+    snapshot.numSkippedBlocks = numSkippedBlocks.load (std::memory_order_relaxed);
+    snapshot.numStateResets = numStateResets.load (std::memory_order_relaxed);
+
+    if (snapshot.numBlocks == 0)
+        return snapshot;
+
+    snapshot.minBlockMicros = minNanos.load (std::memory_order_relaxed) * 0.001;
+    snapshot.maxBlockMicros = maxNanos.load (std::memory_order_relaxed) * 0.001;
+    snapshot.averageBlockMicros = (double) totalNanos.load (std::memory_order_relaxed) * 0.001 / (double) snapshot.numBlocks;
+
+    // The buckets are read one by one while the audio thread keeps adding to
+    // them, so count them up rather than trusting numBlocks for the total.
+    std::array<juce::uint32, numBuckets> counts;
+    juce::uint64 total = 0;
+
+    for (size_t i = 0; i < counts.size(); ++i)
+        total += (counts[i] = histogram[i].load (std::memory_order_relaxed));
+
+    const auto target = (double) total * 0.99;
+    juce::uint64 seen = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += counts[(size_t) i];
+
+        if ((double) seen >= target)
+        {
+            snapshot.p99BlockMicros = juce::jmin (getBucketUpperMicros (i), snapshot.maxBlockMicros);
+            break;
+        }
+    }
+
+    return snapshot;
+}
+
+//==============================================================================
+double Telemetry::Snapshot::getRedesignRate (const Snapshot& earlier) const noexcept
+{
+    const auto elapsed = timeSeconds - earlier.timeSeconds;
+    return elapsed > 0.0 && numRedesigns >= earlier.numRedesigns ? (double) (numRedesigns - earlier.numRedesigns) / elapsed : 0.0;
+}
+
+juce::String Telemetry::Snapshot::toString (const Snapshot& earlier) const
+{
+    return "Block us  min " + juce::String (minBlockMicros, 1)
+         + "  avg " + juce::String (averageBlockMicros, 1)
+         + "  p99 " + juce::String (p99BlockMicros, 1)
+         + "  max " + juce::String (maxBlockMicros, 1)
+         + "\nRedesigns/s " + juce::String (getRedesignRate (earlier), 1)
+         + "   Skipped " + juce::String (numSkippedBlocks)
+         + "   Resets " + juce::String (numStateResets);
+}
+
+juce::String Telemetry::Snapshot::toJSON (const Snapshot& earlier) const
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty ("blocks", (juce::int64) numBlocks);
+    object->setProperty ("blockMicrosMin", minBlockMicros);
+    object->setProperty ("blockMicrosAvg", averageBlockMicros);
+    object->setProperty ("blockMicrosP99", p99BlockMicros);
+    object->setProperty ("blockMicrosMax", maxBlockMicros);
+    object->setProperty ("redesigns", (juce::int64) numRedesigns);
+    object->setProperty ("redesignsPerSecond", getRedesignRate (earlier));
+    object->setProperty ("skippedBlocks", (juce::int64) numSkippedBlocks);
+    object->setProperty ("stateResets", (juce::int64) numStateResets);
+    return juce::JSON::toString (juce::var (object));
+}
+
+//==============================================================================
+TelemetryFileWriter::TelemetryFileWriter (const Telemetry& source, const juce::File& fileToWrite)
+    : telemetry (source), file (fileToWrite)
+{
+    previous = telemetry.getSnapshot();
+    startTimer (1000);
+}
+
+TelemetryFileWriter::~TelemetryFileWriter()
+{
+    stopTimer();
+    file.deleteFile();
+}
+
+void TelemetryFileWriter::timerCallback()
+{
+    const auto snapshot = telemetry.getSnapshot();
+
+    // Write then rename, so a reader never sees a half-written file.
+    const auto temp = file.getSiblingFile (file.getFileName() + ".tmp");
+
+    if (temp.replaceWithText (snapshot.toJSON (previous)))
+        temp.moveFileTo (file);
+
+    previous = snapshot;
+}
+
+#endif
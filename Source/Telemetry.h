@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    Telemetry.h
+
+    Per-instance performance counters. The audio thread is the only writer
+    and only does relaxed loads and stores, so recording costs a couple of
+    clock reads and a handful of plain stores per block. Anything else may
+    read a Snapshot at any time.
+
+    Build with VONIC_TELEMETRY=0 to compile all of it out.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef VONIC_TELEMETRY
+ #define VONIC_TELEMETRY 1
+#endif
+
+#if VONIC_TELEMETRY
+
+class Telemetry
+{
+public:
+    struct Snapshot
+    {
+        double timeSeconds = 0.0;
+
+        juce::uint64 numBlocks = 0;
+        double minBlockMicros = 0.0, averageBlockMicros = 0.0, p99BlockMicros = 0.0, maxBlockMicros = 0.0;
+
+        juce::uint64 numRedesigns = 0;
+        juce::uint64 numSkippedBlocks = 0;
+        juce::uint64 numStateResets = 0;
+
+        /** Redesigns per second between an earlier snapshot and this one. */
+        double getRedesignRate (const Snapshot& earlier) const noexcept;
+
+        juce::String toString (const Snapshot& earlier) const;
+        juce::String toJSON (const Snapshot& earlier) const;
+    };
+
+    Telemetry();
+
+    //==============================================================================
+    // Audio thread only.
+    static juce::int64 startBlock() noexcept { return juce::Time::getHighResolutionTicks(); }
+    void endBlock (juce::int64 startTicks) noexcept;
+
+    void addRedesign() noexcept                { increment (numRedesigns); }
+    void addSkippedBlock() noexcept            { increment (numSkippedBlocks); }
+    void addStateResets (juce::uint32 count) noexcept
+    {
+        numStateResets.store (numStateResets.load (std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    // Any thread.
+    Snapshot getSnapshot() const noexcept;
+
+private:
+    static void increment (std::atomic<juce::uint64>& counter) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Four buckets per octave of nanoseconds, which keeps p99 within ~20%.
+    static constexpr int bucketsPerOctave = 4;
+    static constexpr int numBuckets = 32 * bucketsPerOctave;
+    static int getBucket (juce::uint32 nanos) noexcept;
+    static double getBucketUpperMicros (int bucket) noexcept;
+
+    std::array<std::atomic<juce::uint32>, numBuckets> histogram;
+    std::atomic<juce::uint64> numBlocks { 0 }, totalNanos { 0 };
+    std::atomic<juce::uint32> minNanos { std::numeric_limits<juce::uint32>::max() }, maxNanos { 0 };
+    std::atomic<juce::uint64> numRedesigns { 0 }, numSkippedBlocks { 0 }, numStateResets { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (Telemetry)
+};
+
+//==============================================================================
+/** Writes a Telemetry snapshot as JSON once a second, for collectors outside
+    the host process. Pointing it at /dev/shm keeps it off the disk.
+*/
+class TelemetryFileWriter  : private juce::Timer
+{
+public:
+    TelemetryFileWriter (const Telemetry& source, const juce::File& fileToWrite);
+    ~TelemetryFileWriter() override;
+
+private:
+    void timerCallback() override;
+
+    const Telemetry& telemetry;
+    const juce::File file;
+    Telemetry::Snapshot previous;
+
+    JUCE_DECLARE_NON_COPYABLE (TelemetryFileWriter)
+};
+
+#endif
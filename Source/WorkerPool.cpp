@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+
+#if JUCE_LINUX
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+static_assert (sizeof (std::atomic<juce::uint32>) == sizeof (juce::uint32), "futex words have to be plain 32-bit ints");
+
+class WorkerPool::Worker  : public juce::Thread
+{
+public:
+    Worker (WorkerPool& p, int index, juce::uint32 firstGeneration)
+        : juce::Thread ("Vonic worker " + juce::String (index)), pool (p), seen (firstGeneration)
+    {
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            waitWhileEqual (pool.generation, seen, pool.numSleepingWorkers);
+            seen = pool.generation.load();
+
+            if (pool.stopping)
+                return;
+
+            pool.work (seen);
+        }
+    }
+
+private:
+    WorkerPool& pool;
+
+    // Taken before the thread starts, so that a run() straight after
+    // start() can't be missed.
+    juce::uint32 seen;
+};
+
+//==============================================================================
+WorkerPool::WorkerPool() = default;
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+void WorkerPool::start (int numWorkers, int blockSize, double sampleRate)
+{
+    stop();
+
+    // The same deadline as the callback they work for, so that the system
+    // schedules them the way it schedules that.
+    const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime (blockSize, sampleRate);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back (std::make_unique<Worker> (*this, i + 1, generation.load()));
+
+        // Without the rights to real-time scheduling (as for most users on
+        // Linux), the best there is is a normal thread at the top priority.
+        if (! workers.back()->startRealtimeThread (options))
+            workers.back()->startThread (juce::Thread::Priority::highest);
+    }
+}
+
+void WorkerPool::stop()
+{
+    if (workers.empty())
+        return;
+
+    stopping = true;
+    ++generation;
+
+    // Wakes everyone, sleeping or not.
+    const std::atomic<juce::uint32> everyone { (juce::uint32) workers.size() };
+    wake (generation, everyone, (int) workers.size());
+
+    for (auto& worker : workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+    stopping = false;
+}
+
+//==============================================================================
+void WorkerPool::run (int newNumTasks, Task newTask, void* newContext) noexcept
+{
+    if (workers.empty() || newNumTasks <= 1)
+    {
+        for (int i = 0; i < newNumTasks; ++i)
+            newTask (newContext, i);
+
+        return;
+    }
+
+    jassert (newNumTasks <= maxTasks);
+
+    task = newTask;
+    context = newContext;
+    numUnfinished = (juce::uint32) newNumTasks;
+
+    const auto newGeneration = generation.load() + 1;
+    claim.store (((juce::uint64) newGeneration << 32) | ((juce::uint64) newNumTasks << 16), std::memory_order_release);
+    generation = newGeneration;
+
+    // The caller takes a task too, so the rest need a worker each at most.
+    wake (generation, numSleepingWorkers, newNumTasks - 1);
+
+    work (newGeneration);
+
+    for (auto unfinished = numUnfinished.load(); unfinished != 0; unfinished = numUnfinished.load())
+        waitWhileEqual (numUnfinished, unfinished, numSleepingCallers);
+}
+
+void WorkerPool::work (juce::uint32 forGeneration) noexcept
+{
+    auto current = claim.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto taskIndex = (int) (current & 0xffff);
+
+        if ((juce::uint32) (current >> 32) != forGeneration || taskIndex >= (int) ((current >> 16) & 0xffff))
+            return;
+
+        // A failed exchange reloads current, and it's checked again.
+        if (! claim.compare_exchange_weak (current, current + 1, std::memory_order_acquire))
+            continue;
+
+        task (context, taskIndex);
+
+        if (numUnfinished.fetch_sub (1) == 1)
+            wake (numUnfinished, numSleepingCallers, 1);
+
+        current = claim.load (std::memory_order_acquire);
+    }
+}
+
+//==============================================================================
+void WorkerPool::waitWhileEqual (const std::atomic<juce::uint32>& word, juce::uint32 value,
+                                 std::atomic<juce::uint32>& numSleepers) noexcept
+{
+    const auto spinUntil = juce::Time::getHighResolutionTicks()
+                         + juce::Time::secondsToHighResolutionTicks (spinMicroseconds * 1.0e-6);
+
+    // The clock is only read now and then, since it costs more than a pause.
+    for (int i = 1; word.load() == value; ++i)
+    {
+        if ((i & 63) == 0 && juce::Time::getHighResolutionTicks() >= spinUntil)
+            break;
+
+       #if JUCE_INTEL
+        _mm_pause();
+       #endif
+    }
+
+    // Counted before the last look at word, which wake() relies on.
+    ++numSleepers;
+
+    while (word.load() == value)
+    {
+       #if JUCE_LINUX
+        // Returns at once if word has moved on since the load above.
+        syscall (SYS_futex, reinterpret_cast<const juce::uint32*> (&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+       #else
+        std::this_thread::sleep_for (std::chrono::microseconds (100));
+       #endif
+    }
+
+    --numSleepers;
+}
+
+void WorkerPool::wake (std::atomic<juce::uint32>& word, const std::atomic<juce::uint32>& numSleepers, int maxToWake) noexcept
+{
+    // word has just been changed. A thread that isn't counted yet will see
+    // that change when it looks again after counting itself, so skipping
+    // the system call here is safe.
+   #if JUCE_LINUX
+    if (numSleepers.load() > 0 && maxToWake > 0)
+        syscall (SYS_futex, reinterpret_cast<juce::uint32*> (&word), FUTEX_WAKE_PRIVATE, maxToWake, nullptr, nullptr, 0);
+   #else
+    juce::ignoreUnused (word, numSleepers, maxToWake);
+   #endif
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+
+    A few threads that help the audio thread through one block, for buses
+    with too many channels to filter on a single core in time. Unlike
+    juce::ThreadPool this one is built for the audio callback: run()
+    takes no locks and allocates nothing, and the threads are started
+    ahead of time, from prepareToPlay(), as real-time threads with the
+    audio callback's own budget.
+
+    Between blocks a worker spins for spinMicroseconds, so that a block
+    arriving soon after the last one finds it awake, then sleeps on a
+    futex until the next run() wakes it; run() wakes no more of them than
+    there are tasks for. The caller works through the tasks alongside the
+    workers, and waits the same way at the end for the tasks still
+    running, which is the barrier that ends the block. A worker that wakes
+    too late to be given a task holds nothing up.
+
+    Off Linux the sleep is a short timed one instead of a futex.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WorkerPool
+{
+public:
+    using Task = void (*) (void* context, int taskIndex) noexcept;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    /** Stops any running workers and starts numWorkers new ones, scheduled
+        like an audio callback of blockSize samples at sampleRate. Not for
+        the audio thread.
+    */
+    void start (int numWorkers, int blockSize, double sampleRate);
+    void stop();
+
+    int getNumWorkers() const noexcept   { return (int) workers.size(); }
+
+    /** Calls task (context, i) for every i from 0 to numTasks - 1, spread
+        over the workers and the calling thread, and returns once they have
+        all finished. With no workers it just runs them in order. There
+        can be up to maxTasks.
+    */
+    void run (int numTasks, Task task, void* context) noexcept;
+
+    /** Task taskIndex's share of numItems, when they are split into numTasks
+        runs of consecutive items as even as they can be.
+    */
+    static juce::Range<int> getGroup (int numItems, int numTasks, int taskIndex) noexcept
+    {
+        return { numItems * taskIndex / numTasks, numItems * (taskIndex + 1) / numTasks };
+    }
+
+    static constexpr double spinMicroseconds = 50.0;
+    static constexpr int maxTasks = 0xffff;
+
+private:
+    class Worker;
+
+    void work (juce::uint32 forGeneration) noexcept;
+
+    // All seq_cst, so a thread about to sleep and one about to wake it
+    // can't miss each other (see wake()).
+    static void waitWhileEqual (const std::atomic<juce::uint32>& word, juce::uint32 value,
+                                std::atomic<juce::uint32>& numSleepers) noexcept;
+    static void wake (std::atomic<juce::uint32>& word, const std::atomic<juce::uint32>& numSleepers, int maxToWake) noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Bumped by run() to start the workers. numUnfinished is set to the
+    // number of tasks and counted down as each one finishes.
+    std::atomic<juce::uint32> generation { 0 }, numUnfinished { 0 };
+    std::atomic<juce::uint32> numSleepingWorkers { 0 }, numSleepingCallers { 0 };
+    std::atomic<bool> stopping { false };
+
+    // The generation of the latest run() in the top 32 bits, then its number
+    // of tasks and the next one to hand out, 16 bits each. Tasks are taken
+    // with a compare-and-swap on the whole word, so a worker woken for one
+    // run can't take a task of the next one after that has started.
+    std::atomic<juce::uint64> claim { 0 };
+
+    // Set by run() before it stores claim, and only read by a thread that
+    // has just taken a task of that run.
+    Task task = nullptr;
+    void* context = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerPool)
+};
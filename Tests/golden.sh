@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+# Checks a built standalone against the golden references in Tests/Golden:
+#
+#   Tests/golden.sh [path/to/VonicForContribs] [--max-ulps=<n>]
+#
+# or, on a build whose output is known to be right, writes them:
+#
+#   Tests/golden.sh --write [path/to/VonicForContribs]
+#
+# The binary defaults to the Linux Makefile's Debug/Release output.
+
+set -e
+
+tests=$(cd "$(dirname "$0")" && pwd)
+golden="$tests/Golden"
+
+mode=--verify-golden
+if [ "$1" = "--write" ]; then
+    mode=--write-golden
+    shift
+fi
+
+binary="$tests/../Builds/LinuxMakefile/build/VonicForContribs"
+case "$1" in
+    ""|--*) ;;
+    *) binary=$1; shift ;;
+esac
+
+if [ ! -x "$binary" ]; then
+    echo "No standalone build at $binary, run make in Builds/LinuxMakefile or pass its path" >&2
+    exit 2
+fi
+
+if [ "$mode" = --verify-golden ] && ! ls "$golden"/*.golden > /dev/null 2>&1; then
+    echo "No references in $golden, write them with $0 --write on a known-good build" >&2
+    exit 2
+fi
+
+exec "$binary" "$mode" "$golden" "$@"